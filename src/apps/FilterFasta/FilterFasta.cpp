@@ -28,9 +28,18 @@
  #include <fstream>
  #include <sstream>
  #include <unordered_map>
- #include <Fasta/Fasta.hpp>
+ #include <thread>
+ #include <future>
+ #include <memory>
+ #include <Fasta/FastaReader.hpp>
+ #include <Fasta/FastaCap.hpp>
+ #include <Fasta/FastaCorp.hpp>
+ #include <Utility/BoundedQueue.hpp>
  #include <Filters/SEG.hpp>
  #include <Filters/XNU.hpp>
+ #include <Filters/DUST.hpp>
+ #include <Filters/Pipeline.hpp>
+ #include <Filters/MaskCache.hpp>
  #include <boost/program_options.hpp>
  
  namespace po = boost::program_options;
@@ -72,6 +81,99 @@ ______________________________________________________________________\n\
 
 
 
+/* Consecutive records travelling from the reader through a worker to the
+ * writer. The writer takes batches in input order and waits for each.
+ */
+struct Batch{
+   unsigned long  first;       /* record number of caps[0] (1 based) */
+   vector<string> caps;        /* raw header lines */
+   vector<string> corps;       /* raw sequences */
+   promise<string> out;        /* filtered text, set by a worker */
+};
+typedef shared_ptr<Batch> BatchPtr;
+
+const size_t kBatchRecs  = 256;
+const size_t kBatchBytes = 1 << 20;
+
+
+/* What FilterFasta writes for every record */
+enum OutFormat { kFull, kBed, kSoft, kHard };
+
+struct OutSpec{
+   OutFormat      format;
+   vector<string> chains;      /* bed: one chain per name column, soft/hard: chains[0] */
+   string         taxid;
+   bool           dust;        /* full: add the DUST block */
+};
+
+
+OutFormat ParseFormat(const string& f){
+   if (f.compare("full") == 0)
+      return kFull;
+   if (f.compare("bed") == 0)
+      return kBed;
+   if (f.compare("soft") == 0)
+      return kSoft;
+   if (f.compare("hard") == 0)
+      return kHard;
+   throw runtime_error ("Unknown output format: " + f);
+}
+
+vector<string> SplitChains(const string& list){
+   vector<string> chains;
+   stringstream ss(list);
+   string c;
+   while (getline(ss, c, ','))
+      if (c.size() > 0)
+         chains.push_back(c);
+   if (chains.empty())
+      throw runtime_error ("No filter chain given!");
+   return chains;
+}
+
+
+void FilterBatch(Batch& b, FilterPipeline<int>& Pipe, const OutSpec& spec){
+   string out;
+
+   for (size_t i = 0; i < b.caps.size(); i++){
+      string& seq = b.corps[i];
+      CleanCorp(seq);
+      Pipe.SetSequence(seq);
+
+      if (spec.format == kBed){
+         /* chrom start end name, 0 based half open */
+         string id = b.caps[i].substr(0, b.caps[i].find_first_of(" \t"));
+         for (size_t c = 0; c < spec.chains.size(); c++){
+            vector<Interval<int>> ivs = Pipe.Mask(spec.chains[c]);
+            for (size_t k = 0; k < ivs.size(); k++)
+               out += id + "\t" + to_string(ivs[k].begin) + "\t" + to_string(ivs[k].end + 1)
+                    + "\t" + spec.chains[c] + "\n";
+         }
+         continue;
+      }
+
+      out += ">si|" + FormatCapSi(spec.taxid, b.first + i, "0") + "|ti|" + spec.taxid + "|ss|0\t"
+           + b.caps[i].substr(0, b.caps[i].find('\t')) + "\n";
+      if (spec.format == kSoft){
+         ApplyMask(seq, Pipe.Mask(spec.chains[0]), (char) 0);
+         out += seq + "\n";
+      }else if (spec.format == kHard){
+         out += Pipe.Filter(spec.chains[0]) + "\n";
+      }else{
+         out += "RAW:\n" + seq + "\n";
+         out += "SEG:\n" + Pipe.Filter("SEG") + "\n";
+         out += "XNU:\n" + Pipe.Filter("XNU") + "\n";
+         out += "SEG+XNU:\n" + Pipe.Filter("SEG+XNU") + "\n";
+         if (spec.dust)
+            out += "DUST:\n" + Pipe.Filter("DUST") + "\n";
+      }
+   }
+   vector<string>().swap(b.caps);
+   vector<string>().swap(b.corps);
+   b.out.set_value(std::move(out));
+}
+
+
 template <typename INT, typename CHARA>
 po::variables_map SetOptions(INT& argc, CHARA& argv){
 
@@ -95,6 +197,16 @@ po::variables_map SetOptions(INT& argc, CHARA& argv){
             ("probability,p", po::value< string >(), "Probability cutoff.")
             ("min_search_offset,m", po::value< string >(), "Minimum search offset.")
             ("max_search_offset,M", po::value< string >(), "Maximum search offset.")  
+            ("exact_h", "XNU: compute the score cutoff from the exact matrix entropy instead of its integer part (by default PAM120/250 mask every repeat).")
+            ("prescreen,Q", "Skip SEG on sequences without low complexity windows.")
+            ("dust,D", "Add DUST masked output (DNA).")
+            ("dust_window", po::value< string >(), "DUST window size.")
+            ("dust_level", po::value< string >(), "DUST score threshold.")
+            ("threads,j", po::value< string >(), "Number of filtering threads (default 1).")
+            ("cache,C", po::value< string >(), "Remember the masks of up to this many distinct sequences per filter (0: off, default).")
+            ("cache_file", po::value< string >(), "Load the mask cache from this file if it exists and save it when done (implies --cache 1000000).")
+            ("format,f", po::value< string >(), "Output: full (RAW/SEG/XNU/SEG+XNU blocks, default), bed (masked intervals), soft (lower case mask) or hard (masked sequence).")
+            ("chain,c", po::value< string >(), "Filter chain for bed/soft/hard, e.g. SEG+XNU or SEG|DUST. bed takes a comma separated list (default SEG,XNU); soft/hard take one (default SEG+XNU).")
         ;
 
         po::positional_options_description p;
@@ -151,24 +263,61 @@ try{
       Arg["maxXes"]  = arg["maxxs"].as<string>();
    if(arg.count("maxtrim"))
       Arg["maxtrim"] = arg["maxtrim"].as<string>();
+   if(arg.count("prescreen"))
+      Arg["prescreen"] = "1";
 
    if(arg.count("score"))
       Arg["scut"]    = arg["score"].as<string>();
    if(arg.count("probability"))
       Arg["pcut"]    = arg["probability"].as<string>();
+/* XNU scans the diagonals mcut..ncut (ncut 0: all of them) */
    if(arg.count("min_search_offset"))
-      Arg["ncut"]    = arg["min_search_offset"].as<string>();
+      Arg["mcut"]    = arg["min_search_offset"].as<string>();
    if(arg.count("max_search_offset"))
-      Arg["mcut"]    = arg["max_search_offset"].as<string>();
+      Arg["ncut"]    = arg["max_search_offset"].as<string>();
    if(arg.count("pam"))
       Arg["pam"]  = arg["pam"].as<string>();
+   if(arg.count("exact_h"))
+      Arg["truncate_h"] = "F";
 
-   
-   Fasta<int> NewFastaObj(in, taxid);
-   SEG<int> SegFilt;
-   XNU<int> XnuFilt;
-   
-   unordered_map<string,string> seqs = NewFastaObj.GetFastaAll();
+   if(arg.count("dust_window"))
+      Arg["dust_window"] = arg["dust_window"].as<string>();
+   if(arg.count("dust_level"))
+      Arg["dust_level"]  = arg["dust_level"].as<string>();
+
+   unsigned threads = arg.count("threads") ? StringToNumeric<unsigned>(arg["threads"].as<string>()) : 1;
+   bool dust = arg.count("dust");
+   if (threads < 1)
+      threads = 1;
+
+   OutSpec spec;
+   spec.format = arg.count("format") ? ParseFormat(arg["format"].as<string>()) : kFull;
+   spec.chains = SplitChains(arg.count("chain") ? arg["chain"].as<string>() : (spec.format == kBed ? "SEG,XNU" : "SEG+XNU"));
+   spec.taxid  = taxid;
+   spec.dust   = dust;
+   if (spec.format != kBed && spec.chains.size() > 1)
+      throw runtime_error ("Only bed output takes a list of chains!");
+
+   size_t cachesize = arg.count("cache") ? StringToNumeric<size_t>(arg["cache"].as<string>()) : 0;
+   string cachefile = arg.count("cache_file") ? arg["cache_file"].as<string>() : "";
+   if (cachefile.size() > 0 && !arg.count("cache"))
+      cachesize = 1000000;
+
+   FastaReader Reader(in);
+   const SEG<int> SegFilt(Arg);     /* shared by all workers */
+   const XNU<int> XnuFilt(Arg);
+   const DUST<int> DustFilt(Arg);
+
+   unique_ptr<MaskCache<int>> Memo;
+   if (cachesize > 0){
+      Memo.reset(new MaskCache<int>(cachesize));
+      if (cachefile.size() > 0 && ifstream(cachefile.c_str()).good())
+         Memo->Load(cachefile);
+   }
+
+/* report a bad chain before any output is written */
+   for (size_t c = 0; c < spec.chains.size(); c++)
+      FilterPipeline<int>::Validate(spec.chains[c], true);
    
     ofstream fs;
    streambuf *backup;
@@ -183,21 +332,100 @@ try{
    }
 
 
-   for(auto it = seqs.begin(); it!=seqs.end();it++){
-      cout << ">si|"<<it->first << "|ti|" 
-              << NewFastaObj.GetCapTiForSi(it->first)  
-              << "|ss|"<< NewFastaObj.GetCapSsForSi(it->first)
-              << "\t"<< NewFastaObj.GetCapMetaForSi(it->first) << endl;
-      cout << "RAW:\n"<< it->second << endl;
-      cout << "SEG:\n" << SegFilt.Filter(it->second) << endl;
-      cout << "XNU:\n" << XnuFilt.Filter(it->second) << endl;
-      cout << "SEG+XNU:\n" << XnuFilt.Filter(SegFilt.Filter(it->second)) << endl;
+/* reader -> workers -> writer (this thread). At most 4*threads batches
+ * are in flight, so memory does not depend on the input size.
+ */
+   BoundedQueue<BatchPtr> Work(2*threads), Order(4*threads);
+   exception_ptr ReadErr, WriteErr;
+   vector<thread> Pool;
+
+   for (unsigned t = 0; t < threads; t++)
+      Pool.push_back(thread([&](){
+         FilterPipeline<int> Pipe(SegFilt, XnuFilt, DustFilt);
+         Pipe.SetCache(Memo.get());
+         BatchPtr b;
+         while (Work.Pop(b)){
+            try{
+               FilterBatch(*b, Pipe, spec);
+            }catch(...){
+               b->out.set_exception(current_exception());
+            }
+         }
+      }));
+
+   thread ReadThread([&](){
+      string cap, corp;
+      BatchPtr b;
+      size_t bytes = 0;
+      unsigned long n = 0;
+      try{
+         while (Reader.Next(cap, corp)){
+            if (!b){
+               b = make_shared<Batch>();
+               b->first = n + 1;
+               bytes = 0;
+            }
+            n++;
+            bytes += corp.size();
+            b->caps.push_back(std::move(cap));
+            b->corps.push_back(std::move(corp));
+            if (b->caps.size() >= kBatchRecs || bytes >= kBatchBytes){
+               if (!Order.Push(b) || !Work.Push(b))
+                  break;
+               b.reset();
+            }
+         }
+         if (b && Order.Push(b))
+            Work.Push(b);
+      }catch(...){
+         ReadErr = current_exception();
+      }
+      Order.Close();
+      Work.Close();
+   });
+
+   try{
+      BatchPtr b;
+      while (Order.Pop(b)){
+         string text = b->out.get_future().get();
+         cout.write(text.data(), text.size());
+      }
+   }catch(...){
+      WriteErr = current_exception();
+      Order.Close();
+      Work.Close();
    }
+   ReadThread.join();
+   for (size_t t = 0; t < Pool.size(); t++)
+      Pool[t].join();
+   cout.flush();
    
    if ( fs.is_open()){
       cout.rdbuf(backup);
       fs.close();
    }
+
+   if (ReadErr)
+      rethrow_exception(ReadErr);
+   if (WriteErr)
+      rethrow_exception(WriteErr);
+
+   if (Memo){
+      unsigned long hits   = Memo->GetObjSummary("Hits");
+      unsigned long misses = Memo->GetObjSummary("Misses");
+      cerr << "Mask cache: " << hits << " hits, " << misses << " misses ("
+           << (hits + misses ? 100.0*hits/(hits + misses) : 0.0) << "% hit rate), "
+           << Memo->GetObjSummary("Entries") << " entries\n";
+      if (cachefile.size() > 0)
+         Memo->Save(cachefile);
+   }
+
+   if(arg.count("prescreen")){
+      unsigned long screened = SegFilt.GetPrescreenSummary("Screened");
+      unsigned long skipped  = SegFilt.GetPrescreenSummary("Skipped");
+      cerr << "SEG pre-screen skipped " << skipped << " of " << screened << " sequences ("
+           << (screened ? 100.0*skipped/screened : 0.0) << "%)\n";
+   }
 }catch(runtime_error& e){
       cerr << e.what() << "\n";
 }
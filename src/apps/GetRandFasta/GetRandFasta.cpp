@@ -29,8 +29,19 @@
  #include <fstream>
  #include <cstdlib>
  #include <unordered_map>
+ #include <algorithm>
+ #include <random>
+ #include <thread>
+ #include <mutex>
+ #include <atomic>
+ #include <sys/mman.h>
  #include <Utility/ConvertString.hpp>
+ #include <Utility/Reservoir.hpp>
  #include <Fasta/Fasta.hpp>
+ #include <Fasta/FastaReader.hpp>
+ #include <Fasta/FastaCorp.hpp>
+ #include <Fasta/FastaIndex.hpp>
+ #include <Fasta/FastaSplit.hpp>
  #include <boost/program_options.hpp>
  
  namespace po = boost::program_options;
@@ -86,6 +97,12 @@ po::variables_map SetOptions(INT& argc, CHARA& argv){
             ("taxid,t", po::value< string >(), "taxid")
             ("output-file,o", po::value< string >(), "output file")
             ("number,l", po::value< string >(), "The number of random sequences to be retrieved.")
+            ("method,m", po::value< string >(), "load (load the whole file; output in the format of older releases, default), reservoir (one pass, memory for the sample only), index (read only the sampled records), weighted (chance proportional to --weight) or stratified (--number records per taxon).")
+            ("weight,w", po::value< string >(), "Weight for weighted/stratified: length (residues, default for weighted) or uniform (default for stratified).")
+            ("threads,j", po::value< string >(), "Number of sampling threads for weighted/stratified (default 1); the sample does not depend on it.")
+            ("chunk_size,c", po::value< string >(), "Bytes of input per work unit for weighted/stratified, K/M/G suffix (default 64M); with --seed it fixes the sample.")
+            ("index,x", po::value< string >(), "Index for --method index: a FastaPlus index (records are looked up in place) or a .fai; created by a scan if missing (default: <input>.fai if present, else scan).")
+            ("seed,S", po::value< string >(), "Seed of the random number generator; the same seed gives the same sample (default: random).")
         ;
 
         po::positional_options_description p;
@@ -124,8 +141,258 @@ po::variables_map SetOptions(INT& argc, CHARA& argv){
 }
 
 
- 
- 
+/* A record kept by a sampler, with its position in the input */
+struct Sampled{
+   uint64_t n;
+   double key;          /* weighted/stratified: larger keys win */
+   string cap;
+   string corp;
+
+   bool operator<(const Sampled& o) const { return n < o.n; }
+};
+
+uint64_t SeedFromDevice(){
+   random_device rd;
+   return ((uint64_t) rd() << 32) ^ rd();
+}
+
+/* Prints records in input order */
+void PrintSample(vector<Sampled>& sample){
+   sort(sample.begin(), sample.end());
+   for (size_t i = 0; i < sample.size(); i++)
+      cout << ">" << sample[i].cap << "\n" << sample[i].corp << "\n";
+}
+
+/* Reads the record at [start,end) of fd; the range has to hold a header
+ * at the start of a line */
+void ReadRecordAt(int fd, uint64_t start, uint64_t end, string& buf, Sampled& r){
+   buf.resize(end - start);
+   if (buf.size() > 0)
+      ReadAt(fd, &buf[0], buf.size(), start);
+   size_t h = (buf.size() > 0 && buf[0] == '>') ? 0 : buf.find("\n>");
+   if (h == string::npos)
+      throw runtime_error ("No fasta record at offset " + NumericToString(start));
+   if (h > 0)
+      h++;
+   size_t nl = min(buf.find('\n', h), buf.size());
+   r.cap.assign(buf, h + 1, nl - h - 1);
+   r.corp.assign(buf, min(nl + 1, buf.size()), string::npos);
+   CleanCorp(r.corp);
+}
+
+/*
+ * Streaming uniform sample of k records: a single pass, only the sample is
+ * kept in memory and skipped records are never copied.
+ */
+void SampleReservoir(const string& in, size_t k, uint64_t seed){
+   FastaReader Reader(in);
+   Reservoir<Sampled> res(k, seed);
+   string cap, corp;
+
+   while (Reader.Next(cap, corp)){
+      long s = res.Slot();
+      if (s < 0)
+         continue;
+      Sampled& r = res[s];
+      r.n = Reader.GetObjSummary("TotSeq");
+      r.cap.swap(cap);
+      r.corp.swap(corp);
+      CleanCorp(r.corp);
+   }
+   if (res.GetSample().size() < k)
+      throw runtime_error ("The number of fasta sequences is smaller than the number you have choosen:" + NumericToString(k));
+   PrintSample(res.GetSample());
+}
+
+/*
+ * Uniform sample of k records read in place: k distinct record numbers
+ * are drawn (Floyd) and only those records are read, in file order. With
+ * a FastaPlus index the index itself is not loaded either.
+ */
+void SampleIndexed(const string& in, const string& index, size_t k, uint64_t seed){
+   Random rng(seed);
+   vector<pair<uint64_t,uint64_t>> ranges;
+   struct stat st;
+   if (stat(in.c_str(), &st) != 0)
+      throw runtime_error ("Cannot open file: " + in );
+
+   if (index.size() > 0 && FastaIndexFile::IsIndexFile(index)){
+      FastaIndexFile idx(index);
+      if (idx.GetObjSummary("FileSize") != (uint64_t) st.st_size)
+         throw runtime_error ("Index " + index + " does not match " + in );
+      if (k > idx.Size())
+         throw runtime_error ("The number of fasta sequences is smaller than the number you have choosen:" + NumericToString(k));
+      vector<uint64_t> ids = SampleDistinct(idx.Size(), k, rng);
+      ranges.resize(ids.size());
+      for (size_t i = 0; i < ids.size(); i++)
+         idx.Range(ids[i], ranges[i].first, ranges[i].second);
+   }else{
+      FastaIndex idx;
+      MakeFastaIndex(in, index, idx);
+      if (k > idx.Size())
+         throw runtime_error ("The number of fasta sequences is smaller than the number you have choosen:" + NumericToString(k));
+      vector<uint64_t> ids = SampleDistinct(idx.Size(), k, rng);
+      for (size_t i = 0; i < ids.size(); i++)
+         ranges.push_back(make_pair(idx.Start(ids[i]), idx.End(ids[i])));
+   }
+
+   int fd = open(in.c_str(), O_RDONLY);
+   if (fd < 0)
+      throw runtime_error ("Cannot open file: " + in );
+   string buf;
+   Sampled r;
+   try{
+      for (size_t i = 0; i < ranges.size(); i++){
+         ReadRecordAt(fd, ranges[i].first, ranges[i].second, buf, r);
+         cout << ">" << r.cap << "\n" << r.corp << "\n";
+      }
+   }catch(...){
+      close(fd);
+      throw;
+   }
+   close(fd);
+}
+
+/* Larger key first, then earlier record */
+bool KeyOrder(const Sampled& a, const Sampled& b){
+   return a.key > b.key || (a.key == b.key && a.n < b.n);
+}
+
+/* Keeps the k records with the largest keys */
+void KeepTop(vector<Sampled>& v, size_t k){
+   if (v.size() <= k)
+      return;
+   nth_element(v.begin(), v.begin() + k, v.end(), KeyOrder);
+   v.resize(k);
+}
+
+/* Offset of the first '>' at or after pos that begins a line, or n */
+size_t NextRecord(const char* b, size_t n, size_t pos){
+   if (pos == 0){
+      if (n > 0 && b[0] == '>')
+         return 0;
+      pos = 1;
+   }
+   while (pos < n){
+      const char* nl = (const char*) memchr(b + pos - 1, '\n', n - pos + 1);
+      if (nl == NULL)
+         return n;
+      size_t q = nl - b + 1;
+      if (q < n && b[q] == '>')
+         return q;
+      pos = q + 1;
+   }
+   return n;
+}
+
+/*
+ * Weighted (A-ExpJ) sample of k records, or k per taxon when stratified.
+ * The file is cut into chunks of a fixed size; a record belongs to the
+ * chunk holding its '>'. Chunk c is sampled with its own generator seeded
+ * by StreamSeed(seed, c) and the chunk samples are merged by key, so the
+ * result depends on the seed and the chunk size but not on the number of
+ * threads or the order chunks finish in.
+ */
+void SampleChunked(const string& in, size_t k, uint64_t seed, bool stratify, bool bylength,
+                   const string& taxid, unsigned threads, uint64_t chunk){
+   int fd = open(in.c_str(), O_RDONLY);
+   if (fd < 0)
+      throw runtime_error ("Cannot open file: " + in );
+   struct stat st;
+   fstat(fd, &st);
+   size_t size = st.st_size;
+   const char* b = NULL;
+   if (size > 0){
+      void* m = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (m == MAP_FAILED){
+         close(fd);
+         throw runtime_error ("Cannot map file: " + in );
+      }
+      madvise(m, size, MADV_SEQUENTIAL);
+      b = (const char*) m;
+   }
+   close(fd);
+
+   uint64_t nchunks = (size + chunk - 1) / chunk;
+   atomic<uint64_t> next(0);
+   unordered_map<string, vector<Sampled>> sample;
+   mutex lock;
+   string error;
+
+   auto work = [&](){
+      try{
+         uint64_t c;
+         while ((c = next++) < nchunks){
+            Random rng(StreamSeed(seed, c));
+            unordered_map<string, WeightedReservoir<Sampled>> res;
+            size_t last = min<uint64_t>(size, (c + 1) * chunk);
+
+            for (size_t r = NextRecord(b, size, c * chunk); r < last; ){
+               size_t end = NextRecord(b, size, r + 1);
+               const char* nl = (const char*) memchr(b + r, '\n', end - r);
+               size_t seq = nl ? nl - b + 1 : end;
+               double w = 1;
+               if (bylength){
+                  w = 0;
+                  for (size_t i = seq; i < end; i++)
+                     w += !isspace((unsigned char) b[i]);
+               }
+               if (w > 0){
+                  string ti;
+                  if (stratify && !TaxonSplitter::TaxonOf(string(b + r + 1, seq - r - 1 - (nl != NULL)), ti))
+                     ti = taxid;
+                  auto it = res.find(ti);
+                  if (it == res.end())
+                     it = res.insert(make_pair(ti, WeightedReservoir<Sampled>(k, rng))).first;
+                  long s = it->second.Slot(w);
+                  if (s >= 0){
+                     Sampled& x = it->second[s];
+                     x.n = r;
+                     x.cap.assign(b + r + 1, seq - r - 1 - (nl != NULL));
+                     x.corp.assign(b + seq, end - seq);
+                     CleanCorp(x.corp);
+                  }
+               }
+               r = end;
+            }
+
+            lock_guard<mutex> lk(lock);
+            for (auto it = res.begin(); it != res.end(); ++it){
+               vector<Sampled>& items = it->second.GetSample();
+               vector<Sampled>& all = sample[it->first];
+               for (size_t i = 0; i < items.size(); i++){
+                  items[i].key = it->second.Key(i);
+                  all.push_back(std::move(items[i]));
+               }
+               KeepTop(all, k);
+            }
+         }
+      }catch(exception& e){
+         lock_guard<mutex> lk(lock);
+         error = e.what();
+         next = nchunks;
+      }
+   };
+
+   vector<thread> Pool;
+   for (unsigned t = 1; t < threads; t++)
+      Pool.push_back(thread(work));
+   work();
+   for (size_t t = 0; t < Pool.size(); t++)
+      Pool[t].join();
+   if (b != NULL)
+      munmap((void*) b, size);
+   if (error.size() > 0)
+      throw runtime_error (error);
+
+   vector<Sampled> out;
+   for (auto it = sample.begin(); it != sample.end(); ++it)
+      for (size_t i = 0; i < it->second.size(); i++)
+         out.push_back(std::move(it->second[i]));
+   if (!stratify && out.size() < k)
+      throw runtime_error ("The number of fasta sequences is smaller than the number you have choosen:" + NumericToString(k));
+   PrintSample(out);
+}
 
  
  int main(int argc, char **argv){
@@ -141,13 +408,25 @@ try{
    string output   = arg.count("output-file") ? arg["output-file"].as<string>() : "";  
 
    
-   Fasta<int> NewFastaObj(in, taxid);
-   unordered_map<string, string> fasta = NewFastaObj.GetFastaAll();
-   unordered_map<string,string> keys; 
-   
-   if( StringToNumeric<int>(num) > fasta.size())
-      throw runtime_error ("The number of fasta sequences is smaller than the number you have choosen:" +  num);
-      
+   string method  =  arg.count("method") ? arg["method"].as<string>() : "load";
+   uint64_t seed  =  arg.count("seed") ? StringToNumeric<uint64_t>(arg["seed"].as<string>()) : SeedFromDevice();
+
+   string index   =  arg.count("index") ? arg["index"].as<string>() : "";
+   bool stratify  =  method.compare("stratified") == 0;
+   string weight  =  arg.count("weight") ? arg["weight"].as<string>() : (stratify ? "uniform" : "length");
+   unsigned threads = arg.count("threads") ? StringToNumeric<unsigned>(arg["threads"].as<string>()) : 1;
+   uint64_t chunk =  arg.count("chunk_size") ? StringToSize(arg["chunk_size"].as<string>()) : (1 << 26);
+
+   if (method.compare("load") != 0 && method.compare("reservoir") != 0 && method.compare("index") != 0
+       && method.compare("weighted") != 0 && !stratify)
+      throw runtime_error ("Unknown sampling method: " + method);
+   if (weight.compare("length") != 0 && weight.compare("uniform") != 0)
+      throw runtime_error ("Unknown weight: " + weight);
+   if (threads < 1)
+      threads = 1;
+   if (chunk < 1)
+      throw runtime_error ("The chunk size must be at least 1");
+
    ofstream fs;
    streambuf *backup;
    
@@ -160,15 +439,31 @@ try{
        
    }
 
-   for(int x = 0; x< StringToNumeric<int>(num); ){
-      srand(time(NULL)+x);
-      auto random_it = next(begin(fasta), rand()%(fasta.size()-0 + 1) + 0);
-      if(keys.find(random_it->first) == keys.end()){
+   if (method.compare("reservoir") == 0){
+      SampleReservoir(in, StringToNumeric<size_t>(num), seed);
+   }else if (method.compare("index") == 0){
+      SampleIndexed(in, index, StringToNumeric<size_t>(num), seed);
+   }else if (method.compare("weighted") == 0 || stratify){
+      SampleChunked(in, StringToNumeric<size_t>(num), seed, stratify, weight.compare("length") == 0,
+                    taxid, threads, chunk);
+   }else{
+      Fasta<int> NewFastaObj(in, taxid);
+      unordered_map<string, string> fasta = NewFastaObj.GetFastaAll();
+   
+      if( StringToNumeric<size_t>(num) > fasta.size())
+         throw runtime_error ("The number of fasta sequences is smaller than the number you have choosen:" +  num);
+
+/* distinct positions in the map, sorted, so one walk over it visits all */
+      Random rng(seed);
+      vector<uint64_t> pick = SampleDistinct(fasta.size(), StringToNumeric<int>(num), rng);
+      auto random_it = begin(fasta);
+      uint64_t at = 0;
+      for(size_t x = 0; x < pick.size(); x++){
+         advance(random_it, pick[x] - at);
+         at = pick[x];
          cout <<  NewFastaObj.GetCapMetaForSi(random_it->first) << endl;
          cout << random_it->second << endl;
-         keys[random_it->first] = "check";
-         x++;
-      } 
+      }
    }
    
    if ( fs.is_open()){
@@ -29,9 +29,19 @@
  #include <sstream>
  #include <fstream>
  #include <cstdlib>
+ #include <cstring>
+ #include <memory>
+ #include <queue>
+ #include <algorithm>
+ #include <cstdint>
  #include <unordered_map>
  #include <Utility/ConvertString.hpp>
- #include <Fasta/Fasta.hpp>
+ #include <Fasta/FastaReader.hpp>
+ #include <Fasta/FastaCorp.hpp>
+ #include <Fasta/FastaIndex.hpp>
+ #include <Fasta/FastaSplit.hpp>
+ #include <Utility/FileCopy.hpp>
+ #include <Utility/ShardWriter.hpp>
  #include <boost/program_options.hpp>
  
  namespace po = boost::program_options;
@@ -87,6 +97,15 @@ po::variables_map SetOptions(INT& argc, CHARA& argv){
             ("taxid,t", po::value< string >(), "taxid")
             ("output-file,o", po::value< string >(), "output file")
             ("number,l", po::value< string >(), "The number of files.")
+            ("verbatim,r", "Copy records as they are (header and line breaks) instead of rewriting them.")
+            ("zero_copy,z", "Like --verbatim, but records are located with an index and moved by the kernel (copy_file_range/sendfile).")
+            ("index,x", po::value< string >(), "Index for --zero_copy: a .fai or a FastaPlus index; created by a scan if missing (default: <input>.fai if present, else scan).")
+            ("max_open", po::value< string >(), "Output files kept open at a time (default 256).")
+            ("buffer", po::value< string >(), "Memory for buffered output, K/M/G suffix (default 64M).")
+            ("strategy,s", po::value< string >(), "round (record k to file k % n, default), lpt (balance sizes) or contiguous (consecutive records, equal sizes).")
+            ("balance,b", po::value< string >(), "Size used by lpt/contiguous/chunk_size: residues (default) or bytes.")
+            ("chunk_size,c", po::value< string >(), "Start a new file every this many residues/bytes (K/M/G suffix) instead of a fixed number of files.")
+            ("by_taxon,T", "One file per taxon (ti of indexed headers, --taxid for raw ones), written as DmpFastaAll does.")
         ;
 
         po::positional_options_description p;
@@ -110,7 +129,7 @@ po::variables_map SetOptions(INT& argc, CHARA& argv){
             cout << "Input file is not defined \n";
             exit(0);
         }
-        if (!vm.count("number")){
+        if (!vm.count("number") && !vm.count("chunk_size") && !vm.count("by_taxon")){
             cout << "The number of random sequences to be retrieved not specified \n";
             exit(0);
         }
@@ -125,10 +144,320 @@ po::variables_map SetOptions(INT& argc, CHARA& argv){
 }
 
 
- 
- 
 
- 
+
+/* How records are assigned to files */
+enum Strategy { kRound, kLpt, kContiguous };
+enum Metric   { kResidues, kBytes };
+
+/* Size of a record as written: its bytes and its residues (sequence
+ * characters other than white space, i.e. what CleanCorp keeps). */
+struct RecSize{
+   unsigned long bytes;
+   unsigned long residues;
+};
+
+
+/**
+ * Shard of every record, in input order:
+ *    round       record k goes to k % n
+ *    lpt         longest record first to the least loaded shard (needs all sizes)
+ *    contiguous  consecutive records; a new shard starts once the current
+ *                one reaches Target (the total / n, or a given chunk size)
+ */
+class ShardPlan {
+   Strategy Strat;
+   Metric   Metr;
+   size_t   Shards;
+   unsigned long Target;
+   vector<size_t> Fixed;             /* lpt: shard per record */
+   unsigned long K;                  /* records assigned */
+   unsigned long Cur;                /* contiguous: current shard */
+   unsigned long Fill;               /* contiguous: size of the current shard */
+
+   public:
+
+   ShardPlan(Strategy st, Metric m, size_t shards, unsigned long target)
+      :Strat(st), Metr(m), Shards(shards), Target(target ? target : 1), K(0), Cur(0), Fill(0){}
+
+/* lpt: greedy assignment of the given record sizes */
+   void Balance(const vector<unsigned long>& w){
+      vector<size_t> order(w.size());
+      for (size_t i = 0; i < w.size(); i++)
+         order[i] = i;
+      stable_sort(order.begin(), order.end(), [&](size_t a, size_t b){ return w[a] > w[b]; });
+
+      typedef pair<unsigned long, size_t> Load;                /* size, shard */
+      priority_queue<Load, vector<Load>, greater<Load>> heap;
+      for (size_t s = 0; s < Shards; s++)
+         heap.push(Load(0, s));
+
+      Fixed.assign(w.size(), 0);
+      for (size_t i = 0; i < order.size(); i++){
+         Load l = heap.top();
+         heap.pop();
+         Fixed[order[i]] = l.second;
+         l.first += w[order[i]];
+         heap.push(l);
+      }
+   }
+
+/* Shard of the next record */
+   size_t Next(){
+      switch (Strat){
+         case kLpt:
+            return Fixed[K++];
+         case kContiguous:
+            if (Fill >= Target && Cur + 1 < Shards){
+               Cur++;
+               Fill = 0;
+            }
+            K++;
+            return Cur;
+         default:
+            return K++ % Shards;
+      }
+   }
+
+/* Size of the record just written */
+   void Add(const RecSize& r){
+      Fill += (Metr == kBytes) ? r.bytes : r.residues;
+   }
+};
+
+
+/* Header as written, i.e. the meta Fasta keeps for it: the text up to
+ * the first tab, or with --taxid INDEXED (headers loaded as they are) the
+ * field after the first tab. Offset and length in cap. */
+inline pair<size_t, size_t> MetaOf(const string& cap, bool indexed){
+   size_t t = min(cap.find('\t'), cap.size());
+   if (!indexed)
+      return make_pair((size_t) 0, t);
+   if (t == cap.size())
+      return make_pair(t, (size_t) 0);
+   return make_pair(t + 1, min(cap.find('\t', t + 1), cap.size()) - t - 1);
+}
+
+/* Rewriting split: only the record being copied is held in memory. */
+template <typename Visit>
+void ForEachRecord(const string& in, bool indexed, Visit visit){
+   FastaReader Reader(in);
+   string cap, corp;
+
+   while (Reader.Next(cap, corp)){
+      CleanCorp(corp);
+      RecSize r = {MetaOf(cap, indexed).second + corp.size() + 3, corp.size()};
+      visit(cap, corp, r);
+   }
+}
+
+void SplitRecords(const string& in, bool indexed, ShardWriter& files, ShardPlan& plan){
+   ForEachRecord(in, indexed, [&](const string& cap, const string& corp, const RecSize& r){
+      size_t k = plan.Next();
+      pair<size_t, size_t> meta = MetaOf(cap, indexed);
+      files.Write(k, ">", 1);
+      files.Write(k, cap.data() + meta.first, meta.second);
+      files.Write(k, "\n", 1);
+      files.Write(k, corp.data(), corp.size());
+      files.Write(k, "\n", 1);
+      plan.Add(r);
+   });
+}
+
+
+/* Verbatim split: the input is read in large blocks and every record is
+ * handed on as the byte range(s) it occupies, without looking at its
+ * lines. A record starts at a '>' that begins a line; anything before
+ * the first one is skipped. The visitor gets Start(), Data(p, n) for
+ * each piece and Finish().
+ */
+template <typename Visitor>
+void ScanVerbatim(const string& in, Visitor& v){
+   const size_t kBlock = 1 << 22;
+   ifstream fs(in.c_str(), ios::in | ios::binary);
+   if ( !fs.is_open())
+      throw runtime_error ("Cannot open file: " + in );
+
+   vector<char> buf(kBlock);
+   bool open = false;         /* inside a record */
+   bool newline = true;       /* last byte read ends a line */
+
+   while (fs){
+      fs.read(buf.data(), kBlock);
+      size_t got = fs.gcount();
+      if (got == 0)
+         break;
+
+      const char* beg = buf.data();
+      const char* end = beg + got;
+      const char* span = beg;
+      const char* p = beg;
+      const char* q;
+
+      while ((q = (const char*) memchr(p, '>', end - p)) != NULL){
+         if (q == beg ? newline : q[-1] == '\n'){
+            if (open){
+               if (q > span)
+                  v.Data(span, q - span);
+               v.Finish();
+            }
+            v.Start();
+            open = true;
+            span = q;
+         }
+         p = q + 1;
+      }
+      if (open && end > span)
+         v.Data(span, end - span);
+      newline = (end[-1] == '\n');
+   }
+   if (open)
+      v.Finish();
+}
+
+/* Size of a record passed as pieces; a missing final newline is counted
+ * since the writer adds it. */
+struct VerbatimSize{
+   RecSize size;
+   bool header;               /* still in the header line */
+   bool closed;               /* last byte is a newline */
+
+   void Start(){
+      size.bytes = size.residues = 0;
+      header = true;
+      closed = true;
+   }
+   void Data(const char* p, size_t n){
+      size.bytes += n;
+      closed = (p[n-1] == '\n');
+      if (header){
+         const char* e = (const char*) memchr(p, '\n', n);
+         if (e == NULL)
+            return;
+         header = false;
+         n -= e + 1 - p;
+         p = e + 1;
+      }
+      for (size_t i = 0; i < n; i++)
+         size.residues += !isspace((unsigned char) p[i]);
+   }
+   void Finish(){
+      if (!closed)
+         size.bytes++;
+   }
+};
+
+struct VerbatimWeigher : VerbatimSize{
+   Metric metric;
+   vector<unsigned long>* sizes;        /* per record, or NULL */
+   unsigned long total;
+
+   void Finish(){
+      VerbatimSize::Finish();
+      unsigned long w = (metric == kBytes) ? size.bytes : size.residues;
+      total += w;
+      if (sizes != NULL)
+         sizes->push_back(w);
+   }
+};
+
+struct VerbatimWriter : VerbatimSize{
+   ShardWriter* files;
+   ShardPlan*  plan;
+   size_t      cur;
+
+   void Start(){
+      VerbatimSize::Start();
+      cur = plan->Next();
+   }
+   void Data(const char* p, size_t n){
+      VerbatimSize::Data(p, n);
+      files->Write(cur, p, n);
+   }
+   void Finish(){
+      VerbatimSize::Finish();
+      if (!closed)
+         files->Write(cur, "\n", 1);
+      plan->Add(size);
+   }
+};
+
+
+/* Zero copy split: records are located with an index and every run of
+ * consecutive records bound for the same file is moved as one byte range
+ * by the kernel. Output is the same as with --verbatim.
+ */
+void SplitRanges(const string& in, const FastaIndex& idx, ShardWriter& files, ShardPlan& plan){
+   int fd = open(in.c_str(), O_RDONLY);
+   if (fd < 0)
+      throw runtime_error ("Cannot open file: " + in );
+
+   try{
+      size_t run = 0;              /* file of the pending range */
+      uint64_t from = 0, to = 0;   /* pending range */
+
+      for (size_t i = 0; i < idx.Size(); i++){
+         size_t k = plan.Next();
+         if (to > from && (k != run || idx.Start(i) != to)){
+            files.Copy(run, fd, from, to - from);
+            from = to;
+         }
+         if (to == from){
+            run = k;
+            from = idx.Start(i);
+         }
+         to = idx.End(i);
+         RecSize r = {idx.Bytes(i), idx.Residues(i)};
+         plan.Add(r);
+      }
+      if (to > from)
+         files.Copy(run, fd, from, to - from);
+
+      char last = '\n';
+      if (idx.Size() > 0 && idx.End(idx.Size()-1) > 0)
+         pread(fd, &last, 1, idx.End(idx.Size()-1) - 1);
+      if (last != '\n')
+         files.Write(run, "\n", 1);
+   }catch(...){
+      close(fd);
+      throw;
+   }
+   close(fd);
+}
+
+/* First pass for lpt and count based contiguous splits: record sizes
+ * (lpt only) and their total. With an index no pass is needed. */
+unsigned long Weigh(const string& in, bool indexed, bool verbatim, const FastaIndex* idx, Metric m, vector<unsigned long>* sizes){
+   if (idx != NULL){
+      unsigned long total = 0;
+      for (size_t i = 0; i < idx->Size(); i++){
+         unsigned long w = (m == kBytes) ? idx->Bytes(i) : idx->Residues(i);
+         total += w;
+         if (sizes != NULL)
+            sizes->push_back(w);
+      }
+      return total;
+   }
+   if (verbatim){
+      VerbatimWeigher v;
+      v.metric = m;
+      v.sizes = sizes;
+      v.total = 0;
+      ScanVerbatim(in, v);
+      return v.total;
+   }
+   unsigned long total = 0;
+   ForEachRecord(in, indexed, [&](const string&, const string&, const RecSize& r){
+      unsigned long w = (m == kBytes) ? r.bytes : r.residues;
+      total += w;
+      if (sizes != NULL)
+         sizes->push_back(w);
+   });
+   return total;
+}
+
+
+
  int main(int argc, char **argv){
    
    po::variables_map arg;
@@ -138,39 +467,83 @@ po::variables_map SetOptions(INT& argc, CHARA& argv){
 try{
    string in      =  arg["input-file"].as<string>();
    string taxid   =  arg.count("taxid") ? arg["taxid"].as<string>() : "1";
-   string num     =  arg["number"].as<string>();
    string output   = arg.count("output-file") ? arg["output-file"].as<string>()+"." : "fasta.";  
+   bool indexed   =  taxid.compare("INDEXED") == 0;
+   bool verbatim  =  arg.count("verbatim");
+   bool zerocopy  =  arg.count("zero_copy");
 
-   
-   Fasta<int> NewFastaObj(in, taxid);
-   unordered_map<string, string> fasta = NewFastaObj.GetFastaAll();
-   unordered_map<string,string> keys; 
-   
-   if( StringToNumeric<int>(num) > 800)
-      throw runtime_error ("The maximum number of splits: 800");
-   
-  
-   
-   vector<shared_ptr<ofstream>> files;
-    
-   
-   for(int i =0; i < StringToNumeric<int>(num); i++){
-      stringstream ss;
-      ss<<(i+1);
-      string filename(output.c_str()+ss.str());
-      files.push_back( make_shared<ofstream>( filename ) );
-   }
-     
-   int x = 0;
-   for( auto it = fasta.begin(); it!= fasta.end(); it++,x++ ){
-      *files[x%StringToNumeric<int>(num)] << ">"<<NewFastaObj.GetCapMetaForSi(it->first)
-                                           << "\n" 
-                                           << it->second<< endl;
-       
+   string strat   =  arg.count("strategy") ? arg["strategy"].as<string>() : "round";
+   string metric  =  arg.count("balance") ? arg["balance"].as<string>() : "residues";
+   unsigned long chunk = arg.count("chunk_size") ? StringToSize(arg["chunk_size"].as<string>()) : 0;
+   long num       =  arg.count("number") ? StringToNumeric<long>(arg["number"].as<string>()) : 0;
+   size_t maxopen = arg.count("max_open") ? StringToNumeric<size_t>(arg["max_open"].as<string>()) : 256;
+   size_t budget  = arg.count("buffer") ? StringToSize(arg["buffer"].as<string>()) : (1 << 26);
+
+   if (arg.count("by_taxon")){
+      TaxonSplitter split(output, taxid, maxopen, budget);
+      split.Split(in);
+      split.Close();
+      return 0;
    }
-   
-   for(int i =0; i < files.size(); i++)
-      files[i]->close();
+
+   Strategy st;
+   if (chunk > 0 || strat.compare("contiguous") == 0)
+      st = kContiguous;
+   else if (strat.compare("lpt") == 0)
+      st = kLpt;
+   else if (strat.compare("round") == 0)
+      st = kRound;
+   else
+      throw runtime_error ("Unknown split strategy: " + strat);
+
+   Metric m;
+   if (metric.compare("residues") == 0)
+      m = kResidues;
+   else if (metric.compare("bytes") == 0)
+      m = kBytes;
+   else
+      throw runtime_error ("Unknown balance: " + metric);
+
+   if (chunk == 0 && num < 1)
+      throw runtime_error ("The number of splits must be at least 1");
+
+   FastaIndex Idx;
+   if (zerocopy)
+      MakeFastaIndex(in, arg.count("index") ? arg["index"].as<string>() : "", Idx);
+   const FastaIndex* idx = zerocopy ? &Idx : NULL;
+
+   ShardWriter files(output, maxopen, budget);
+   unique_ptr<ShardPlan> plan;
+   if (chunk > 0){
+      plan.reset(new ShardPlan(kContiguous, m, (size_t) -1, chunk));
+   }else if (st == kLpt){
+      vector<unsigned long> sizes;
+      Weigh(in, indexed, verbatim, idx, m, &sizes);
+      plan.reset(new ShardPlan(kLpt, m, num, 0));
+      plan->Balance(sizes);
+   }else if (st == kContiguous){
+      unsigned long total = Weigh(in, indexed, verbatim, idx, m, NULL);
+      plan.reset(new ShardPlan(kContiguous, m, num, (total + num - 1) / num));
+   }else{
+      plan.reset(new ShardPlan(kRound, m, num, 0));
+   }
+
+   if (zerocopy){
+      SplitRanges(in, Idx, files, *plan);
+   }else if (verbatim){
+      VerbatimWriter v;
+      v.files = &files;
+      v.plan = plan.get();
+      ScanVerbatim(in, v);
+   }else{
+      SplitRecords(in, indexed, files, *plan);
+   }
+
+/* all n files exist, even if some stay empty */
+   if (chunk == 0)
+      for (long i = 0; i < num; i++)
+         files.Create(i);
+   files.Close();
    
 }catch(runtime_error& e){
       cerr << e.what() << "\n";
@@ -0,0 +1,645 @@
+/*
+ * FilterTest.cpp
+ *
+ * Copyright 2016 Robert Bakaric <rbakaric@irb.hr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+
+
+/* Randomised consistency checks of the filters: fast paths against
+ * their reference implementations. Exits with 1 if a check fails. SIMD
+ * kernels are compared up to the level the processor supports (see
+ * CpuFeatures.hpp); the report names the kernel that was run.
+ * Usage: FilterTest [seed] [rounds]
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_map>
+#include <Utility/Random.hpp>
+#include <Utility/ConvertString.hpp>
+#include <Utility/CpuFeatures.hpp>
+#include <Utility/Alphabet.hpp>
+#include <Filters/XNU.hpp>
+#include <Filters/DUST.hpp>
+#include <Filters/SEG.hpp>
+#include <Filters/Pipeline.hpp>
+
+using namespace std;
+using namespace fastaplus;
+
+
+/* Random sequence over alpha, with tandem repeats of short units mixed in */
+string RandomSeq(Random& rng, const string& alpha, size_t len){
+   string s;
+   while (s.size() < len){
+      if (rng.Below(3) == 0){
+         string unit;
+         size_t ul = 1 + rng.Below(6);
+         for (size_t k = 0; k < ul; k++)
+            unit += alpha[rng.Below(alpha.size())];
+         for (size_t r = 1 + rng.Below(10); r > 0; r--)
+            s += unit;
+      }else{
+         s += alpha[rng.Below(alpha.size())];
+      }
+   }
+   s.resize(len);
+   return s;
+}
+
+template <typename Tint>
+bool SameIntervals(const vector<Interval<Tint>>& a, const vector<Interval<Tint>>& b){
+   if (a.size() != b.size())
+      return false;
+   for (size_t i = 0; i < a.size(); i++)
+      if (a[i].begin != b[i].begin || a[i].end != b[i].end)
+         return false;
+   return true;
+}
+
+bool Fail(const string& test, const string& params, const string& seq){
+   cerr << test << " differs for " << params << " on\n" << seq << "\n";
+   return false;
+}
+
+
+/* Encoding: EncodeBytes (pshufb when the table allows it) against a
+ * plain table lookup, on random bytes and sequences of any length */
+template <typename Alpha>
+bool TestEncodeAlphabet(Random& rng, int rounds, const string& name){
+   typedef typename AlphabetLut<Alpha>::Table Lut;
+   bool letters = LutIsLetterOnly(Lut::code, (unsigned char) Alpha::Other);
+
+   for (int r = 0; r < rounds; r++){
+      string s;
+      for (size_t k = rng.Below(200); k > 0; k--)
+         s += (char) (rng.Below(2) ? Alpha::Letters()[rng.Below(Alpha::Size)] : rng.Below(256));
+      vector<unsigned char> fast(s.size() + 1, 255), slow(s.size());
+      EncodeBytes(Lut::code, letters, (unsigned char) Alpha::Other,
+                  (const unsigned char*) s.data(), fast.data(), s.size());
+      for (size_t i = 0; i < s.size(); i++)
+         slow[i] = Lut::code[(unsigned char) s[i]];
+      if (fast[s.size()] != 255 || !equal(slow.begin(), slow.end(), fast.begin()))
+         return Fail("Encoding", name, s);
+   }
+   return true;
+}
+
+bool TestEncode(Random& rng, int rounds){
+   return TestEncodeAlphabet<Protein20>(rng, rounds, "Protein20")
+       && TestEncodeAlphabet<ProteinIUPAC>(rng, rounds, "ProteinIUPAC")
+       && TestEncodeAlphabet<DNA4>(rng, rounds, "DNA4")
+       && TestEncodeAlphabet<DNAIUPAC>(rng, rounds, "DNAIUPAC");
+}
+
+
+/* XNU: multi offset (SIMD) scan against the scalar scan; kernel is the
+ * simd parameter (sse4.1 or avx2) */
+bool TestXnuLanes(Random& rng, int rounds, const string& kernel){
+   const char* pams[] = {"PAM60", "PAM120", "PAM250"};
+   const char* ncuts[] = {"0", "4", "7", "16", "20", "33"};
+   const string alpha = "ARNDCQEGHILKMFPSTWYVBZX*-arndcqeghilkmfpstwyv";
+
+   for (int r = 0; r < rounds; r++){
+      unordered_map<string,string> par;
+      par["pam"]  = pams[rng.Below(3)];
+      par["ncut"] = ncuts[rng.Below(6)];
+      par["mcut"] = NumericToString(1 + rng.Below(3));
+      if (rng.Below(4) == 0)
+         par["scut"] = NumericToString(5 + rng.Below(30));
+      if (rng.Below(4) == 0)
+         par["truncate_h"] = "F";
+      unordered_map<string,string> ref(par);
+      par["simd"] = kernel;
+      ref["simd"] = "F";
+      XNU<int> fast(par), slow(ref);
+
+      size_t len = (r % 4 == 0) ? rng.Below(40) : 1 + rng.Below(1500);
+      string s = RandomSeq(rng, alpha, len);
+      string params = par["pam"] + " ncut=" + par["ncut"] + " mcut=" + par["mcut"];
+      if (!SameIntervals(fast.Mask(s), slow.Mask(s)) || fast.Filter(s) != slow.Filter(s))
+         return Fail("XNU SIMD scan", params, s);
+   }
+   return true;
+}
+
+
+/* XNU: only the diagonals mcut..ncut are scanned. A tandem repeat of
+ * period p (60 residues) is masked when p is in the range and not when
+ * only offsets beyond the repeat are; an empty range is refused. */
+bool TestXnuOffsets(Random& rng, int rounds){
+   const string alpha = "ARNDCQEGHILKMFPSTWYV";
+
+   for (int r = 0; r < rounds; r++){
+      size_t p = 2 + rng.Below(9);
+      string unit, left = alpha;           /* distinct residues: period exactly p */
+      for (size_t k = 0; k < p; k++){
+         size_t j = rng.Below(left.size());
+         unit += left[j];
+         left.erase(j, 1);
+      }
+      string s;                             /* flanks without repeats */
+      for (size_t k = 20 + rng.Below(50); k > 0; k--)
+         s += alpha[rng.Below(alpha.size())];
+      size_t from = s.size();
+      while (s.size() < from + 60)
+         s += unit;
+      for (size_t k = 20 + rng.Below(50); k > 0; k--)
+         s += alpha[rng.Below(alpha.size())];
+
+      unordered_map<string,string> in, out;
+      in["mcut"]  = NumericToString(1 + rng.Below(p));
+      in["ncut"]  = NumericToString(p + rng.Below(3));
+      out["mcut"] = NumericToString(61 + rng.Below(5));       /* beyond the repeat */
+      out["ncut"] = NumericToString(66 + rng.Below(5));
+      XNU<int> with(in), without(out);
+
+      vector<bool> a = IntervalsToBits(with.Mask(s), s.size());
+      vector<bool> b = IntervalsToBits(without.Mask(s), s.size());
+      size_t ina = 0, inb = 0;
+      for (size_t i = from + p; i < from + 60 - p; i++){
+         ina += a[i];
+         inb += b[i];
+      }
+      string params = "period " + NumericToString(p) + " mcut=" + in["mcut"] + " ncut=" + in["ncut"];
+      if (ina != 60 - 2*p || inb == 60 - 2*p)
+         return Fail("XNU offset range", params, s);
+   }
+
+   unordered_map<string,string> empty;
+   empty["mcut"] = "5";
+   empty["ncut"] = "4";
+   try{
+      XNU<int> none(empty);
+   }catch(runtime_error& e){
+      return true;
+   }
+   return Fail("XNU offset range", "mcut=5 ncut=4 accepted", "");
+}
+
+
+/* DUST: reference masking straight from the definition. The mask is the
+ * union of the perfect intervals (of at most window bases, inside an ACGT
+ * run): intervals whose score exceeds the level and is not exceeded by the
+ * score of any of their subintervals.
+ */
+vector<bool> DustReference(const string& s, int window, int level){
+   int n = s.size();
+   vector<bool> m(n, false);
+/* r[x][y-x], l[x][y-x]: score and triplets-1 of the bases [x,y), y-x <= window */
+   vector<vector<long>> r(n, vector<long>(window + 1, 0)), l(r);
+   for (int x = 0; x < n; x++){
+      int c[64] = {0}, t = 0;
+      for (int y = x + 1; y <= n && y - x <= window; y++){
+         size_t b = string("ACGT").find(s[y-1]);
+         if (b == string::npos)
+            break;
+         t = (t*4 + b) % 64;
+         l[x][y-x] = y - x - 3;
+         r[x][y-x] = r[x][y-x-1] + (y - x >= 3 ? c[t]++ : 0);
+      }
+   }
+
+   for (int a = 0; a < n; a++){
+      for (int b = a + 3; b <= n && b - a <= window; b++){
+         if (string("ACGT").find(s[b-1]) == string::npos)
+            break;
+         long ra = r[a][b-a], la = l[a][b-a];
+         if (!(ra*10 > level*la))
+            continue;
+         bool perfect = true;
+         for (int x = a; x < b && perfect; x++)
+            for (int y = x + 4; y <= b; y++)
+               if (r[x][y-x]*la > ra*l[x][y-x]){
+                  perfect = false;
+                  break;
+               }
+         if (perfect)
+            for (int k = a; k < b; k++)
+               m[k] = true;
+      }
+   }
+   return m;
+}
+
+/* DUST: Mask, the buffered Mask and MaskBits against the reference */
+bool TestDust(Random& rng, int rounds){
+   const char* alphas[] = {"AC", "ACGT", "ACGTN"};
+   const char* windows[] = {"16", "32", "64"};
+   const char* levels[] = {"10", "20", "35"};
+   DUST<int>::Buffer buf;
+
+   for (int r = 0; r < rounds; r++){
+      unordered_map<string,string> par;
+      par["dust_window"] = windows[rng.Below(3)];
+      par["dust_level"]  = levels[rng.Below(3)];
+      DUST<int> dust(par);
+
+      string s = RandomSeq(rng, alphas[r % 3], 20 + rng.Below(150));
+      string params = "window=" + par["dust_window"] + " level=" + par["dust_level"];
+      vector<bool> ref = DustReference(s, StringToNumeric<int>(par["dust_window"]),
+                                          StringToNumeric<int>(par["dust_level"]));
+      if (dust.MaskBits(s) != ref || IntervalsToBits(dust.Mask(s, buf), s.size()) != ref
+                                  || IntervalsToBits(dust.Mask(s), s.size()) != ref)
+         return Fail("DUST", params, s);
+   }
+   return true;
+}
+
+
+/* Low complexity run (one to three residues) of length len written over
+ * s, centred on pos */
+void PlantRun(Random& rng, string& s, const string& alpha, size_t pos, size_t len){
+   string few;
+   for (size_t k = 1 + rng.Below(3); k > 0; k--)
+      few += alpha[rng.Below(alpha.size())];
+   size_t from = pos > len/2 ? pos - len/2 : 0;
+   for (size_t i = from; i < from + len && i < s.size(); i++)
+      s[i] = few[rng.Below(few.size())];
+}
+
+/* SEG: threaded (tiled) scan against the serial one. The tiles start at
+ * (window+1)/2-1 and are chunk long; low complexity runs are planted
+ * across the tile boundaries. */
+bool TestSegChunked(Random& rng, int rounds){
+   const char* windows[] = {"8", "12", "25"};
+   const char* trims[] = {"10", "50", "100"};
+
+   for (int r = 0; r < rounds; r++){
+      unordered_map<string,string> par;
+      bool dna = rng.Below(4) == 0;
+      if (dna)
+         par["alphabet"] = "dna";
+      par["window"]  = windows[rng.Below(3)];
+      par["maxtrim"] = trims[rng.Below(3)];
+      int window = StringToNumeric<int>(par["window"]);
+      int chunk  = window + StringToNumeric<int>(par["maxtrim"]) + rng.Below(50);
+      par["chunk"] = NumericToString(chunk);
+      unordered_map<string,string> ref(par);
+      par["threads"] = NumericToString(2 + rng.Below(3));
+      SEG<int> tiled(par), serial(ref);
+
+      string alpha = dna ? "ACGT" : "ARNDCQEGHILKMFPSTWYV";
+      string s = RandomSeq(rng, alpha, 2*chunk + rng.Below(8*chunk));
+      for (size_t b = (window+1)/2 - 1; b < s.size(); b += chunk)
+         if (rng.Below(3) != 0)
+            PlantRun(rng, s, alpha, b + rng.Below(2*window+1) - window, 5 + rng.Below(3*window));
+
+      string params = par["alphabet"] + " window=" + par["window"] + " chunk=" + par["chunk"]
+                    + " threads=" + par["threads"];
+      if (!SameIntervals(tiled.Mask(s), serial.Mask(s)))
+         return Fail("SEG tiled scan", params, s);
+   }
+   return true;
+}
+
+
+/* SEG: the composition pre-screen must not change the mask. Most
+ * sequences are high complexity with at most a short run planted, so
+ * both skipped and scanned sequences are compared. */
+bool TestSegPrescreen(Random& rng, int rounds){
+   const char* windows[] = {"6", "12", "25"};
+   const char* locuts[] = {"1.8", "2.2", "3.0"};
+   const char* hicuts[] = {"2.5", "3.2"};
+   const char* maxxes[] = {"0", "2", "5"};
+   unsigned long skipped = 0;
+
+   for (int r = 0; r < rounds; r++){
+      unordered_map<string,string> par;
+      bool dna = rng.Below(4) == 0;
+      if (dna){
+         par["alphabet"] = "dna";
+         par["locut"] = "1.2";
+         par["hicut"] = "1.5";
+      }else{
+         par["locut"] = locuts[rng.Below(3)];
+         par["hicut"] = hicuts[rng.Below(2)];
+      }
+      par["window"] = windows[rng.Below(3)];
+      par["maxXes"] = maxxes[rng.Below(3)];
+      unordered_map<string,string> ref(par);
+      par["prescreen"] = "1";
+      SEG<int> screened(par), full(ref);
+
+      string alpha = dna ? "ACGTN" : "ARNDCQEGHILKMFPSTWYVX";
+      string s = RandomSeq(rng, alpha, 1 + rng.Below(400));
+      if (rng.Below(2) == 0)
+         PlantRun(rng, s, alpha, rng.Below(s.size()), 3 + rng.Below(30));
+
+      string params = par["alphabet"] + " window=" + par["window"] + " locut=" + par["locut"]
+                    + " hicut=" + par["hicut"] + " maxXes=" + par["maxXes"];
+      if (!SameIntervals(screened.Mask(s), full.Mask(s)))
+         return Fail("SEG pre-screen", params, s);
+      skipped += screened.GetPrescreenSummary("Skipped");
+   }
+/* a pre-screen that never skips would pass trivially */
+   return skipped > 0;
+}
+
+
+/* SEG: the ln(n!) and entropy tables against lgamma and log. The
+ * parameters put the ends of the tables (the size of lnFactA, window +
+ * maxtrim + 1 and the 256 residue window limit) in the checked range. */
+bool TestSegTables(Random& rng, int rounds){
+   const int nfact = sizeof(lnFactA)/sizeof(*lnFactA);
+   const int windows[] = {1, 12, 45, 255, 256, 257};
+   const double ln2 = log(2.0);
+
+   for (int r = 0; r < rounds; r++){
+      int window  = rng.Below(2) ? windows[rng.Below(6)] : 1 + rng.Below(300);
+      int maxtrim = rng.Below(2) ? rng.Below(200) : nfact - window - 2 + rng.Below(3);
+      unordered_map<string,string> par;
+      par["window"]  = NumericToString(window);
+      par["maxtrim"] = NumericToString(maxtrim);
+      SEG<int> seg(par);
+      string params = "window=" + par["window"] + " maxtrim=" + par["maxtrim"];
+
+      int bound = max(nfact, window + maxtrim + 1);
+      vector<int> ns;
+      for (int n = 0; n < 300; n++)
+         ns.push_back(n);
+      for (int d = -3; d <= 3; d++){
+         ns.push_back(nfact + d);
+         ns.push_back(bound + d);
+      }
+      ns.push_back(bound + rng.Below(4*bound));
+      for (size_t k = 0; k < ns.size(); k++){
+         double ref = lgamma(ns[k] + 1.0);
+         if (fabs(seg.GetLnFact(ns[k]) - ref) > 1e-6 + 1e-9*ref)
+            return Fail("SEG ln(n!) table", params + " n=" + NumericToString(ns[k]), "");
+      }
+
+      for (int total = 1; total <= window + 1; total++)
+         for (int c = 1; c <= total; c++){
+            double ref = c*log((double) c/total)/ln2;
+            if (fabs(seg.GetEntropyTerm(c, total) - ref) > 1e-12*(1 + fabs(ref)))
+               return Fail("SEG entropy table", params + " c=" + NumericToString(c)
+                           + " total=" + NumericToString(total), "");
+         }
+   }
+   return true;
+}
+
+
+/* SEG: masks with and without the tables for windows at the ends of the
+ * entropy table (256 tabulated, 257 not); a low complexity run longer
+ * than the ln(n!) table makes the trim step extend it. */
+bool TestSegTableMasks(Random& rng, int rounds){
+   const char* windows[] = {"255", "256", "257"};
+   const string alpha = "ARNDCQEGHILKMFPSTWYV";
+
+   for (int r = 0; r <= rounds; r++){
+      unordered_map<string,string> par;
+      par["window"] = r < rounds ? windows[rng.Below(3)] : "12";
+      par["locut"]  = r < rounds ? "3.4" : "2.2";
+      par["hicut"]  = r < rounds ? "3.7" : "2.5";
+      unordered_map<string,string> ref(par);
+      ref["tables"] = "0";
+      SEG<int> tabulated(par), direct(ref);
+
+      int window = StringToNumeric<int>(par["window"]);
+      string s;
+      if (r < rounds){
+         s = RandomSeq(rng, alpha, window + rng.Below(3*window));
+         for (int k = rng.Below(3); k > 0; k--)
+            PlantRun(rng, s, alpha, rng.Below(s.size()), window/2 + rng.Below(2*window));
+      }else{
+/* one run past the end of lnFactA */
+         size_t run = sizeof(lnFactA)/sizeof(*lnFactA) + 100;
+         s = RandomSeq(rng, alpha, run + 200);
+         PlantRun(rng, s, alpha, 100 + run/2, run);
+      }
+
+      string params = "window=" + par["window"];
+      if (!SameIntervals(tabulated.Mask(s), direct.Mask(s)))
+         return Fail("SEG tables", params, s);
+   }
+   return true;
+}
+
+
+/* SEG: the fixed size entropy kernels (window 12 or 45, protein or dna)
+ * against the generic scan, which tables=0 selects. X/N residues are
+ * mixed in to exercise maxXes. */
+bool TestSegKernels(Random& rng, int rounds){
+   const char* windows[] = {"12", "45"};
+   const char* locuts[][3] = {{"2.2", "3.0", "3.4"}, {"1.2", "1.5", "1.8"}};
+   const char* maxxes[] = {"0", "2", "5"};
+
+   for (int r = 0; r < rounds; r++){
+      unordered_map<string,string> par;
+      bool dna = rng.Below(2) == 0;
+      if (dna)
+         par["alphabet"] = "dna";
+      par["window"] = windows[rng.Below(2)];
+      par["locut"]  = locuts[dna][rng.Below(3)];
+      par["hicut"]  = NumericToString(StringToNumeric<double>(par["locut"]) + 0.3);
+      par["maxXes"] = maxxes[rng.Below(3)];
+      unordered_map<string,string> ref(par);
+      ref["tables"] = "0";
+      SEG<int> kernel(par), generic(ref);
+
+      int window = StringToNumeric<int>(par["window"]);
+      string alpha = dna ? "ACGTN" : "ARNDCQEGHILKMFPSTWYVX";
+      string s = RandomSeq(rng, alpha, window + rng.Below(20*window));
+      for (int k = rng.Below(4); k > 0; k--)
+         PlantRun(rng, s, alpha, rng.Below(s.size()), 3 + rng.Below(2*window));
+
+      string params = par["alphabet"] + " window=" + par["window"] + " locut=" + par["locut"]
+                    + " maxXes=" + par["maxXes"];
+      if (!SameIntervals(kernel.Mask(s), generic.Mask(s)))
+         return Fail("SEG entropy kernel", params, s);
+   }
+   return true;
+}
+
+
+/* FilterPipeline: "SEG+XNU" is XNU run on the output of SEG (likewise
+ * "XNU+SEG"), "SEG|XNU" the union of both masks. One pipeline evaluates all chains on the same
+ * sequence (sharing the per prefix results), the other starts every chain
+ * on a fresh sequence; both must give the same. */
+bool TestPipeline(Random& rng, int rounds){
+   const char* chains[] = {"SEG", "XNU", "SEG+XNU", "SEG|XNU", "XNU+SEG", "SEG+XNU|SEG"};
+   const string alpha = "ARNDCQEGHILKMFPSTWYVX";
+   SEG<int> seg;
+   XNU<int> xnu;
+   FilterPipeline<int> shared(seg, xnu), fresh(seg, xnu);
+
+   for (int r = 0; r < rounds; r++){
+      string s = RandomSeq(rng, alpha, 1 + rng.Below(400));
+      for (int k = rng.Below(3); k > 0; k--)
+         PlantRun(rng, s, alpha, rng.Below(s.size()), 5 + rng.Below(30));
+/* soft masked stretch: SEG reads it as X, XNU uppercases it */
+      if (rng.Below(2) == 0)
+         for (size_t i = rng.Below(s.size()), e = i + rng.Below(60); i < e && i < s.size(); i++)
+            s[i] = tolower(s[i]);
+
+      string segout = seg.Filter(s);
+      string chained = xnu.Filter(segout);
+      vector<Interval<int>> segivs = seg.Mask(s);
+      vector<Interval<int>> chainivs = UniteIntervals(segivs, xnu.Mask(segout));
+      vector<Interval<int>> unionivs = UniteIntervals(segivs, xnu.Mask(s));
+      string united = segout;
+      xnu.Apply(united, xnu.Mask(s));
+
+      shared.SetSequence(s);
+      for (size_t c = 0; c < sizeof(chains)/sizeof(*chains); c++){
+         fresh.SetSequence(s);
+         string f = fresh.Filter(chains[c]);
+         fresh.SetSequence(s);
+         vector<Interval<int>> m = fresh.Mask(chains[c]);
+         if (f != shared.Filter(chains[c]) || !SameIntervals(m, shared.Mask(chains[c])))
+            return Fail("Pipeline prefix cache", chains[c], s);
+      }
+
+      shared.SetSequence(s);
+      if (shared.Filter("SEG+XNU") != chained || !SameIntervals(shared.Mask("SEG+XNU"), chainivs))
+         return Fail("Pipeline chain", "SEG+XNU", s);
+      if (shared.Filter("SEG|XNU") != united || !SameIntervals(shared.Mask("SEG|XNU"), unionivs))
+         return Fail("Pipeline chain", "SEG|XNU", s);
+      if (shared.Filter("XNU+SEG") != seg.Filter(xnu.Filter(s)))
+         return Fail("Pipeline chain", "XNU+SEG", s);
+   }
+   return true;
+}
+
+
+/* MaskCache: masks served from the cache against recomputed ones, a
+ * Save/Load round trip, and corrupt files. Sequences are drawn from a
+ * small pool so that most lookups hit. */
+bool TestMaskCache(Random& rng, int rounds){
+   const char* chains[] = {"SEG", "XNU", "SEG+XNU", "SEG|XNU"};
+   const string alpha = "ARNDCQEGHILKMFPSTWYV";
+   const string file = "FilterTest.cache";
+   SEG<int> seg;
+   XNU<int> xnu;
+   MaskCache<int> memo(1 << 16, 4);
+   FilterPipeline<int> cached(seg, xnu), plain(seg, xnu);
+   cached.SetCache(&memo);
+
+   vector<string> pool;
+   for (int k = 0; k < 50; k++){
+      pool.push_back(RandomSeq(rng, alpha, 1 + rng.Below(300)));
+      PlantRun(rng, pool.back(), alpha, rng.Below(pool.back().size()), 5 + rng.Below(30));
+   }
+
+   for (int r = 0; r < rounds; r++){
+      const string& s = pool[rng.Below(pool.size())];
+      const char* chain = chains[rng.Below(4)];
+      cached.SetSequence(s);
+      plain.SetSequence(s);
+      if (!SameIntervals(cached.Mask(chain), plain.Mask(chain)))
+         return Fail("MaskCache hit", chain, s);
+   }
+   if (memo.GetObjSummary("Hits") == 0)
+      return false;
+
+/* every mask of the pool is in the cache now, after the round trip no
+ * filter has to run */
+   for (size_t k = 0; k < pool.size(); k++){
+      cached.SetSequence(pool[k]);
+      for (int c = 0; c < 4; c++)
+         cached.Mask(chains[c]);
+   }
+   memo.Save(file);
+   MaskCache<int> loaded(1 << 16, 8);
+   loaded.Load(file);
+   if (loaded.GetObjSummary("Entries") != memo.GetObjSummary("Entries"))
+      return Fail("MaskCache Save/Load", "entries", "");
+
+   FilterPipeline<int> reloaded(seg, xnu);
+   reloaded.SetCache(&loaded);
+   for (size_t k = 0; k < pool.size(); k++){
+      reloaded.SetSequence(pool[k]);
+      plain.SetSequence(pool[k]);
+      for (int c = 0; c < 4; c++)
+         if (!SameIntervals(reloaded.Mask(chains[c]), plain.Mask(chains[c])))
+            return Fail("MaskCache Save/Load", chains[c], pool[k]);
+   }
+   if (reloaded.GetRunSummary("SEG") != 0 || reloaded.GetRunSummary("XNU") != 0)
+      return Fail("MaskCache Save/Load", "filters run after loading", "");
+
+/* a cut file and an absurd interval count must both be refused as
+ * truncated */
+   ifstream in(file.c_str(), ios::binary);
+   string bytes((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+   in.close();
+   string cut = bytes.substr(0, bytes.size() - 3);
+   string huge = bytes.substr(0, 12) + string(16, 'k') + string(8, '\xff');
+   const string* corrupt[] = {&cut, &huge};
+   for (int c = 0; c < 2; c++){
+      ofstream out(file.c_str(), ios::binary);
+      out << *corrupt[c];
+      out.close();
+      MaskCache<int> bad(16);
+      try{
+         bad.Load(file);
+         remove(file.c_str());
+         return Fail("MaskCache Load", c ? "huge count" : "cut file", "");
+      }catch(runtime_error& e){
+         if (string(e.what()).find("Truncated") != 0){
+            remove(file.c_str());
+            return Fail("MaskCache Load", e.what(), "");
+         }
+      }
+   }
+   remove(file.c_str());
+   return true;
+}
+
+
+bool Report(const string& test, bool ok){
+   cout << test << " ... " << (ok ? "ok" : "FAILED") << endl;
+   return ok;
+}
+
+
+int main(int argc, char** argv){
+   uint64_t seed = argc > 1 ? StringToNumeric<uint64_t>(argv[1]) : 1;
+   int rounds    = argc > 2 ? StringToNumeric<int>(argv[2]) : 2000;
+   Random rng(seed);
+   bool ok = true;
+
+   int cpu = CpuSimdLevel();
+   ok = Report(string("Encoding (") + SimdLevelName(min(cpu, (int) kSsse3)) + ") vs table",
+               TestEncode(rng, rounds)) && ok;
+   ok = Report(string("XNU ") + SimdLevelName(min(cpu, (int) kSse41)) + " scan vs scalar",
+               TestXnuLanes(rng, rounds, "sse4.1")) && ok;
+   ok = Report(string("XNU ") + SimdLevelName(min(cpu, (int) kAvx2)) + " scan vs scalar",
+               TestXnuLanes(rng, rounds, "avx2")) && ok;
+   ok = Report("XNU offset range", TestXnuOffsets(rng, rounds/4)) && ok;
+   ok = Report("DUST vs reference", TestDust(rng, rounds/4)) && ok;
+   ok = Report("SEG tiled vs serial scan", TestSegChunked(rng, rounds/4)) && ok;
+   ok = Report("SEG pre-screen vs full scan", TestSegPrescreen(rng, rounds)) && ok;
+   ok = Report("SEG tables vs lgamma/log", TestSegTables(rng, rounds/100)) && ok;
+   ok = Report("SEG masks with vs without tables", TestSegTableMasks(rng, rounds/20)) && ok;
+   ok = Report("SEG entropy kernels vs generic scan", TestSegKernels(rng, rounds)) && ok;
+   ok = Report("Pipeline chains vs filters run one by one", TestPipeline(rng, rounds)) && ok;
+   ok = Report("MaskCache hits and Save/Load", TestMaskCache(rng, rounds)) && ok;
+
+   return ok ? 0 : 1;
+}
@@ -22,6 +22,9 @@
  */
  
  
+#ifndef FASTAPLUS_FASTA_FASTA_HPP
+#define FASTAPLUS_FASTA_FASTA_HPP
+
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -471,13 +474,7 @@ template <typename Tint>
 inline string Fasta<Tint>::CapToIndex(const string& Cap, const string& TaxId, const string& Si){
 
    sid++;
-   stringstream ss;
-   stringstream ssid;
-   ssid << sid;
-   string comp = TaxId + ssid.str()+"/"+Si;
-   ss << setw(30) << setfill('0') << comp;
-   
-   return "si|"+ss.str()+"|ti|"+TaxId+"|ss|"+Si+"|\t"+Cap;
+   return FormatCap(Cap, TaxId, sid, Si);
 }
 
 
@@ -510,3 +507,5 @@ Fasta<Tint>::~Fasta(){
 }
 
 }
+
+#endif
@@ -23,10 +23,15 @@
 
 
 
+#ifndef FASTAPLUS_FASTA_FASTACAP_HPP
+#define FASTAPLUS_FASTA_FASTACAP_HPP
+
 #include <iostream>
 #include <algorithm>
 #include <string>
 #include <vector>
+#include <sstream>
+#include <iomanip>
 #include <unordered_map>
 
 using namespace std;
@@ -346,4 +351,42 @@ void FastaCap::Clear(){
    TiToSi.clear();
 }
 
+
+/*!
+ * FormatCapSi function returns the sequence identifier assigned to the
+ * Sid-th record of a raw fasta file: TaxId, Sid and Ss zero padded to 30
+ * characters.
+ * @param TaxId [const string&]
+ * @param Sid [unsigned long] // 1 based record number
+ * @param Ss [const string&]
+ * @par Example:
+ * @code  FormatCapSi("9606", 3, "0"); // 0000000000000000000000096063/0
+ * @endcode
+ */
+inline string FormatCapSi(const string& TaxId, unsigned long Sid, const string& Ss){
+   stringstream ss;
+   stringstream ssid;
+   ssid << Sid;
+   string comp = TaxId + ssid.str()+"/"+Ss;
+   ss << setw(30) << setfill('0') << comp;
+   return ss.str();
 }
+
+/*!
+ * FormatCap function converts a raw header line into the indexed form.
+ * @param Cap [const string&] // without '>'
+ * @param TaxId [const string&]
+ * @param Sid [unsigned long]
+ * @param Ss [const string&]
+ * @par Example:
+ * @code  FormatCap("ENS937474 additional information", "9606", 1, "0");
+ * // si|000000000000000000000096061/0|ti|9606|ss|0|[tab]ENS937474 additional information
+ * @endcode
+ */
+inline string FormatCap(const string& Cap, const string& TaxId, unsigned long Sid, const string& Ss){
+   return "si|"+FormatCapSi(TaxId, Sid, Ss)+"|ti|"+TaxId+"|ss|"+Ss+"|\t"+Cap;
+}
+
+}
+
+#endif
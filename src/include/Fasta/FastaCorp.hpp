@@ -21,12 +21,18 @@
  * 
  */
 
+#ifndef FASTAPLUS_FASTA_FASTACORP_HPP
+#define FASTAPLUS_FASTA_FASTACORP_HPP
+
 #include <iostream>
 #include <algorithm>
+#include <cctype>
 #include <string>
 #include <vector>
 #include <unordered_map>
 #include <unordered_set>
+#include <stdexcept>
+#include <Utility/Alphabet.hpp>
 
 using namespace std;
 
@@ -40,6 +46,31 @@ using namespace std;
 
 namespace fastaplus {
 
+/*!
+ * CleanCorp function brings a raw sequence into the form kept by FastaCorp:
+ * upper case, without spaces and with every non alphabet character
+ * replaced by X. Any letter is kept (U of RNA, J, O), so the table is
+ * Latin26 rather than one of the residue alphabets.
+ * @param Str [string&]
+ * @par Example:
+ * @code
+ * string x = "aaA 8.a";
+ * CleanCorp(x);
+ * cout << x << endl; // result: AAAXXA
+ * @endcode
+ */
+inline void CleanCorp(string& Str){
+   typedef AlphabetLut<Latin26>::Table Lut;
+   size_t j = 0;
+   for (size_t i = 0; i < Str.size(); i++){
+      unsigned char c = Lut::code[(unsigned char) Str[i]];
+      if (c == Latin26::Space)
+         continue;
+      Str[j++] = c < Latin26::Size ? 'A' + c : 'X';
+   }
+   Str.resize(j);
+}
+
  /** @brief FastaCorp class processes the sequence of a given Fasta record
  */
 
@@ -48,40 +79,7 @@ class FastaCorp {
    unordered_map<string,string> Corpus;
    vector<string>              Identifiers;
    unordered_set<string>       CheckId;
-   
-/*!
- * ToUpperCase function converts lower case letters to their upper case form
- * @param Str [string&]
- * @par Example:
- * @code
- * string x = "AAAhagA";
- * ToUpperCase(x);
- * cout << x << endl; // result: AAAHAGAA
- * @endcode
- */
-   inline void ToUpperCase(string& Str);
-/*!
- * RemoveSpaces function removes spaces from strings
- * @param Str [string&]
- * @par Example:
- * @code
- * string x = "AAA   A";
- * RemoveSpaces(x);
- * cout << x << endl; // result: AAAAA
- * @endcode
- */
-   inline void RemoveSpaces(string& Str);
-/*!
- * MaskDubious function replaces all non alphabet characters with X characters
- * @param  Str [string&]
- * @par Example:
- * @code
- * string x = "AAA 8.A";
- * MaskDubious(x);
- * cout << x << endl; // result: AAAXXXAA
- * @endcode
- */
-   inline void MaskDubious(string& Str);
+   unordered_map<string,vector<unsigned char>> Encoded;
    
 public:
 
@@ -143,9 +141,9 @@ public:
    unordered_map<string,string> GetCorpOnly(const string& Id);
 /*!
  * GetCorpOnly function overload returns a set of specified strings
- * @param Ids [vector<string>&]
+ * @param Ids [const vector<string>&]
  */
-   unordered_map<string,string> GetCorpOnly(vector<string>& Ids);
+   unordered_map<string,string> GetCorpOnly(const vector<string>& Ids);
 /*!
  * GetCorpAllExcept function returns all strings except the one scpecified
  * @param Id [const string&]
@@ -154,13 +152,32 @@ public:
 /*!
  * GetCorpAllExcept function overload returns all strings except the ones 
  * within a given vector
- * @param Ids [vector<string>&]
+ * @param Ids [const vector<string>&]
  */
-   unordered_map<string,string> GetCorpAllExcept(vector<string>& Ids);
+   unordered_map<string,string> GetCorpAllExcept(const vector<string>& Ids);
 /*!
  * GetCorpAllExcept function returns all strings within a containor
  */
    unordered_map<string,string> GetCorpAll();
+/*!
+ * EncodeCorp function translates all strings within a container into the
+ * residue codes of a given alphabet (see Alphabet.hpp) and keeps them next
+ * to the strings. The codes can be passed directly to the Mask overloads of
+ * the filters: Protein20 for SEG, ProteinIUPAC for XNU and DNA4 for DUST.
+ * @par Example:
+ * @code
+ * fastaCorp.EncodeCorp<ProteinIUPAC>();
+ * const vector<unsigned char>& enc = fastaCorp.GetEncodedCorp("ID");
+ * xnu.Mask(enc.data(), enc.size(), scratch);
+ * @endcode
+ */
+   template <typename Alpha>
+   void EncodeCorp();
+/*!
+ * GetEncodedCorp function returns the residue codes of a specific string
+ * @param Id [const string&]
+ */
+   const vector<unsigned char>& GetEncodedCorp(const string& Id);
 /*!
  * The function clears the containor.
  */
@@ -181,6 +198,7 @@ FastaCorp::~FastaCorp(){
 
 void FastaCorp::Clear(){
    Corpus.clear();
+   Encoded.clear();
    vector<string>().swap(Identifiers);
 }
 
@@ -198,10 +216,9 @@ void FastaCorp::LoadCorp(unordered_map<string,string>& Corp){
 
 void FastaCorp::LoadCorp(const string& Id,const string & Corp){
    string s = Corp;
-   ToUpperCase(s);
-   RemoveSpaces(s);
-   MaskDubious(s);
+   CleanCorp(s);
    Corpus[Id] = s;
+   Encoded.erase(Id);
    if(CheckId.find(Id) != CheckId.end()){
       Identifiers.push_back(Id);
       CheckId.insert(Id);
@@ -218,6 +235,7 @@ void FastaCorp::LoadCleanCorp(unordered_map<string,string>& Corp){
 
 void FastaCorp::LoadCleanCorp(const string& Id,const string & Corp){
    Corpus[Id] = Corp;
+   Encoded.erase(Id);
    if(CheckId.find(Id) != CheckId.end()){
       Identifiers.push_back(Id);
       CheckId.insert(Id);
@@ -230,6 +248,21 @@ unordered_map<string,string> FastaCorp::GetCorpAll(){
 }
 
 
+template <typename Alpha>
+void FastaCorp::EncodeCorp(){
+   for ( auto it = Corpus.begin(); it != Corpus.end(); ++it )
+      AlphabetLut<Alpha>::Encode(it->second, Encoded[it->first]);
+}
+
+
+const vector<unsigned char>& FastaCorp::GetEncodedCorp(const string& Id){
+   auto it = Encoded.find(Id);
+   if (it == Encoded.end())
+      throw runtime_error ("No encoded sequence for: " + Id);
+   return it->second;
+}
+
+
 unordered_map<string,string> FastaCorp::GetCorpOnly(const string& Id){
    unordered_map<string,string> str;
    str[Id] = Corpus[Id];
@@ -237,7 +270,7 @@ unordered_map<string,string> FastaCorp::GetCorpOnly(const string& Id){
 }
 
 
-unordered_map<string,string> FastaCorp::GetCorpOnly(vector<string>& Ids){
+unordered_map<string,string> FastaCorp::GetCorpOnly(const vector<string>& Ids){
    unordered_map<string,string> str;
    for(long i =0; i< Ids.size(); i++)
       str[Ids[i]] = Corpus[Ids[i]];
@@ -254,7 +287,7 @@ unordered_map<string,string> FastaCorp::GetCorpAllExcept(const string& Id){
 }
 
 
-unordered_map<string,string> FastaCorp::GetCorpAllExcept(vector<string>& Ids){
+unordered_map<string,string> FastaCorp::GetCorpAllExcept(const vector<string>& Ids){
 
    vector<string> get;
    copy_if(Identifiers.begin(), Identifiers.end(), back_inserter(get),
@@ -264,17 +297,6 @@ unordered_map<string,string> FastaCorp::GetCorpAllExcept(vector<string>& Ids){
 }
 
 
-inline void FastaCorp::ToUpperCase(string& Str){
-   transform(Str.begin(), Str.end(),Str.begin(), ::toupper);
 }
 
-
-inline void FastaCorp::RemoveSpaces(string& Str){
-   Str.erase(remove_if(Str.begin(), Str.end(), ::isspace), Str.end());
-}
-
-
-inline void FastaCorp::MaskDubious(string& Str){
-   replace_if(Str.begin(), Str.end(), [](char c) { return !isalpha(c); }, 'X' );
-}
-}
+#endif
@@ -0,0 +1,487 @@
+/*
+ * FastaIndex.hpp
+ *
+ * Copyright 2016 Robert Bakaric <rbakaric@irb.hr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+
+#ifndef FASTAPLUS_FASTA_FASTAINDEX_HPP
+#define FASTAPLUS_FASTA_FASTAINDEX_HPP
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <cctype>
+#include <cstdint>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <Utility/ConvertString.hpp>
+#include <Utility/FileCopy.hpp>
+
+/** @file FastaIndex.hpp
+ * Byte offsets of the records of a (multi)fasta file.
+ */
+
+using namespace std;
+
+namespace fastaplus {
+
+/**
+ * @brief Record boundaries of a fasta file: where every record starts,
+ * where its sequence starts, where it ends and how many residues it has.
+ *
+ * An index is built by one scan of the file, taken from a samtools .fai
+ * or loaded from a file written by Save.
+ */
+class FastaIndex {
+
+   struct Rec{
+      uint64_t start;            /* offset of '>' */
+      uint64_t seq;              /* offset of the first sequence line */
+      uint64_t end;              /* one past the last byte of the record */
+      uint64_t residues;         /* sequence characters other than white space */
+   };
+
+   vector<Rec> Recs;
+   uint64_t    FileSize;
+
+   public:
+
+/*!
+ * FastaIndex class constructor (empty index).
+ */
+   FastaIndex();
+
+/*!
+ * FastaIndex class destructor.
+ */
+   ~FastaIndex();
+
+/*!
+ * Scan function indexes a fasta file in one pass. A record starts at a
+ * '>' that begins a line; anything before the first one is not indexed.
+ * @param File [const string&]
+ */
+   void Scan(const string& File);
+
+/*!
+ * ReadFai function builds the index from a samtools .fai of File. Record
+ * ends follow from the line layout, so the fai has to describe File
+ * exactly; a mismatch with the file size is an error.
+ * @param Fai [const string&]
+ * @param File [const string&] // the indexed fasta file
+ */
+   void ReadFai(const string& Fai, const string& File);
+
+/*!
+ * Save function writes the index to a binary file.
+ * @param File [const string&]
+ */
+   void Save(const string& File);
+
+/*!
+ * Load function reads an index written by Save.
+ * @param File [const string&]
+ */
+   void Load(const string& File);
+
+/*!
+ * Size function returns the number of records.
+ */
+   size_t Size() const { return Recs.size(); }
+
+/*!
+ * Start function returns the offset of the header of record i.
+ * @param i [size_t]
+ */
+   uint64_t Start(size_t i) const { return Recs[i].start; }
+
+/*!
+ * SeqStart function returns the offset of the sequence of record i.
+ * @param i [size_t]
+ */
+   uint64_t SeqStart(size_t i) const { return Recs[i].seq; }
+
+/*!
+ * End function returns the offset one past the last byte of record i.
+ * @param i [size_t]
+ */
+   uint64_t End(size_t i) const { return Recs[i].end; }
+
+/*!
+ * Bytes function returns the length of record i in the file.
+ * @param i [size_t]
+ */
+   uint64_t Bytes(size_t i) const { return Recs[i].end - Recs[i].start; }
+
+/*!
+ * Residues function returns the number of residues of record i.
+ * @param i [size_t]
+ */
+   uint64_t Residues(size_t i) const { return Recs[i].residues; }
+
+/*!
+ * Object data getter. \n
+ * Getter retrieves the number of records ("TotSeq"), residues ("TotSize")
+ * or the size of the indexed file ("FileSize").
+ * @param What [const string&]
+ */
+   uint64_t GetObjSummary(const string& What) const;
+
+};
+
+
+/**
+ * @brief Random access to an index written by FastaIndex::Save without
+ * loading it: record i is read from the file when it is asked for, so
+ * looking up k records of a huge index costs k small reads.
+ */
+class FastaIndexFile {
+
+   int      Fd;
+   uint64_t NumOfSeq;
+   uint64_t FileSize;
+
+   public:
+
+/*!
+ * FastaIndexFile class constructor.
+ * @param File [const string&] // written by FastaIndex::Save
+ */
+   FastaIndexFile(const string& File);
+
+/*!
+ * FastaIndexFile class destructor.
+ */
+   ~FastaIndexFile();
+
+/*!
+ * IsIndexFile function tells whether File was written by FastaIndex::Save.
+ * @param File [const string&]
+ */
+   static bool IsIndexFile(const string& File);
+
+/*!
+ * Size function returns the number of records.
+ */
+   size_t Size() const { return NumOfSeq; }
+
+/*!
+ * Range function returns where record i starts and ends in the fasta file.
+ * @param i [size_t]
+ * @param Start [uint64_t&] // offset of '>'
+ * @param End [uint64_t&] // one past the last byte
+ */
+   void Range(size_t i, uint64_t& Start, uint64_t& End) const;
+
+/*!
+ * Object data getter. \n
+ * Getter retrieves the number of records ("TotSeq") or the size of the
+ * indexed file ("FileSize").
+ * @param What [const string&]
+ */
+   uint64_t GetObjSummary(const string& What) const;
+
+};
+
+
+static const char kFastaIndexMagic[8] = {'F','P','I','D','X','0','0','1'};
+
+
+/* Constructors */
+inline FastaIndex::FastaIndex():FileSize(0){}
+
+/* Destructors */
+inline FastaIndex::~FastaIndex(){}
+
+
+/* Functions  : Public */
+
+inline void FastaIndex::Scan(const string& File){
+   const size_t kBlock = 1 << 22;
+   ifstream fs(File.c_str(), ios::in | ios::binary);
+   if ( !fs.is_open())
+      throw runtime_error ("Cannot open file: " + File );
+
+   vector<char> buf(kBlock);
+   uint64_t base = 0;            /* file offset of buf[0] */
+   bool newline = true;          /* last byte read ends a line */
+   bool header = false;          /* inside the header line of the last record */
+
+   Recs.clear();
+   while (fs){
+      fs.read(buf.data(), kBlock);
+      size_t got = fs.gcount();
+      if (got == 0)
+         break;
+
+      const char* beg = buf.data();
+      for (size_t i = 0; i < got; i++){
+         char c = beg[i];
+         if (c == '>' && (i == 0 ? newline : beg[i-1] == '\n')){
+            if (!Recs.empty())
+               Recs.back().end = base + i;
+            Rec r = {base + i, base + got, base + got, 0};
+            Recs.push_back(r);
+            header = true;
+            const char* e = (const char*) memchr(beg + i, '\n', got - i);
+            if (e == NULL){
+               i = got - 1;
+               continue;
+            }
+            i = e - beg;
+            Recs.back().seq = base + i + 1;
+            header = false;
+         }else if (header){
+            if (c == '\n'){
+               Recs.back().seq = base + i + 1;
+               header = false;
+            }
+         }else if (!Recs.empty() && !isspace((unsigned char) c)){
+            Recs.back().residues++;
+         }
+      }
+      newline = (beg[got-1] == '\n');
+      base += got;
+   }
+   if (!Recs.empty()){
+      Recs.back().end = base;
+      if (header)
+         Recs.back().seq = base;
+   }
+   FileSize = base;
+}
+
+/* A record whose length is L, with B bases per line of W bytes, ends
+ * L/B full lines and a partial one after its sequence offset. Its header
+ * is the line ending just before the sequence offset; as in Scan, a
+ * record runs up to the header of the next one, and whatever precedes the
+ * first header is not indexed.
+ */
+inline void FastaIndex::ReadFai(const string& Fai, const string& File){
+   int fd = open(File.c_str(), O_RDONLY);
+   if (fd < 0)
+      throw runtime_error ("Cannot open file: " + File );
+   struct stat st;
+   fstat(fd, &st);
+
+   ifstream fs(Fai.c_str(), ios::in);
+   if ( !fs.is_open()){
+      close(fd);
+      throw runtime_error ("Cannot open file: " + Fai );
+   }
+
+   string line;
+   uint64_t last = 0;               /* end of the sequence of the last record */
+   char buf[4096];
+   Recs.clear();
+   try{
+      while (getline(fs, line)){
+         if (line.empty())
+            continue;
+         stringstream ss(line);
+         string name;
+         uint64_t len = 0, off = 0, bases = 0, width = 0;
+         getline(ss, name, '\t');
+         if (!(ss >> len >> off >> bases >> width) || (len > 0 && (bases == 0 || width < bases)))
+            throw runtime_error ("Malformed fai line: " + line);
+         if (off < 2 || off > (uint64_t) st.st_size || off < last)
+            throw runtime_error ("Index " + Fai + " does not match " + File );
+
+         /* back from the newline ending the header to the one before it */
+         uint64_t start = off - 1;
+         bool found = false;
+         while (!found && start > last){
+            size_t n = (size_t) min<uint64_t>(sizeof(buf), start - last);
+            ReadAt(fd, buf, n, start - n);
+            for (size_t i = n; i > 0; i--){
+               if (buf[i-1] == '\n'){
+                  found = true;
+                  break;
+               }
+               start--;
+            }
+         }
+         ReadAt(fd, buf, 1, start);
+         if (buf[0] != '>')
+            throw runtime_error ("Index " + Fai + " does not match " + File );
+
+         uint64_t bytes = (bases == 0) ? 0 : (len / bases) * width + ((len % bases) ? len % bases + (width - bases) : 0);
+         if (off + bytes > (uint64_t) st.st_size + 1)
+            throw runtime_error ("Index " + Fai + " does not match " + File );
+         if (!Recs.empty())
+            Recs.back().end = start;
+         Rec r = {start, off, (uint64_t) st.st_size, len};
+         Recs.push_back(r);
+         last = min<uint64_t>(off + bytes, st.st_size);
+      }
+   }catch(...){
+      close(fd);
+      throw;
+   }
+   close(fd);
+   FileSize = st.st_size;
+}
+
+/* Layout: magic, file size, number of records, then start, seq, end and
+ * residues of each record, all uint64.
+ */
+inline void FastaIndex::Save(const string& File){
+   ofstream fs(File.c_str(), ios::out | ios::binary);
+   if ( !fs.is_open())
+      throw runtime_error ("Cannot open file: " + File );
+
+   uint64_t n = Recs.size();
+   fs.write(kFastaIndexMagic, sizeof(kFastaIndexMagic));
+   fs.write((const char*) &FileSize, sizeof(FileSize));
+   fs.write((const char*) &n, sizeof(n));
+   for (size_t i = 0; i < Recs.size(); i++){
+      fs.write((const char*) &Recs[i].start, sizeof(uint64_t));
+      fs.write((const char*) &Recs[i].seq, sizeof(uint64_t));
+      fs.write((const char*) &Recs[i].end, sizeof(uint64_t));
+      fs.write((const char*) &Recs[i].residues, sizeof(uint64_t));
+   }
+   if (!fs)
+      throw runtime_error ("Cannot write file: " + File );
+}
+
+inline void FastaIndex::Load(const string& File){
+   ifstream fs(File.c_str(), ios::in | ios::binary);
+   if ( !fs.is_open())
+      throw runtime_error ("Cannot open file: " + File );
+
+   char magic[sizeof(kFastaIndexMagic)];
+   uint64_t n = 0;
+   fs.read(magic, sizeof(magic));
+   fs.read((char*) &FileSize, sizeof(FileSize));
+   fs.read((char*) &n, sizeof(n));
+   if (!fs || memcmp(magic, kFastaIndexMagic, sizeof(magic)) != 0)
+      throw runtime_error ("Not a fasta index file: " + File );
+
+   Recs.resize(n);
+   for (size_t i = 0; i < n && fs; i++){
+      fs.read((char*) &Recs[i].start, sizeof(uint64_t));
+      fs.read((char*) &Recs[i].seq, sizeof(uint64_t));
+      fs.read((char*) &Recs[i].end, sizeof(uint64_t));
+      fs.read((char*) &Recs[i].residues, sizeof(uint64_t));
+   }
+   if (!fs)
+      throw runtime_error ("Truncated fasta index file: " + File );
+}
+
+inline FastaIndexFile::FastaIndexFile(const string& File):NumOfSeq(0),FileSize(0){
+   Fd = open(File.c_str(), O_RDONLY);
+   if (Fd < 0)
+      throw runtime_error ("Cannot open file: " + File );
+
+   char head[sizeof(kFastaIndexMagic) + 2 * sizeof(uint64_t)];
+   struct stat st;
+   if (fstat(Fd, &st) != 0 || (uint64_t) st.st_size < sizeof(head)
+       || pread(Fd, head, sizeof(head), 0) != (ssize_t) sizeof(head)
+       || memcmp(head, kFastaIndexMagic, sizeof(kFastaIndexMagic)) != 0){
+      close(Fd);
+      throw runtime_error ("Not a fasta index file: " + File );
+   }
+   memcpy(&FileSize, head + sizeof(kFastaIndexMagic), sizeof(uint64_t));
+   memcpy(&NumOfSeq, head + sizeof(kFastaIndexMagic) + sizeof(uint64_t), sizeof(uint64_t));
+   if ((uint64_t) st.st_size != sizeof(head) + NumOfSeq * 4 * sizeof(uint64_t)){
+      close(Fd);
+      throw runtime_error ("Truncated fasta index file: " + File );
+   }
+}
+
+inline FastaIndexFile::~FastaIndexFile(){
+   close(Fd);
+}
+
+inline bool FastaIndexFile::IsIndexFile(const string& File){
+   char magic[sizeof(kFastaIndexMagic)];
+   ifstream fs(File.c_str(), ios::in | ios::binary);
+   return fs.read(magic, sizeof(magic)) && memcmp(magic, kFastaIndexMagic, sizeof(magic)) == 0;
+}
+
+inline void FastaIndexFile::Range(size_t i, uint64_t& Start, uint64_t& End) const{
+   uint64_t r[4];
+   if (i >= NumOfSeq)
+      throw runtime_error ("Record index out of range");
+   ReadAt(Fd, (char*) r, sizeof(r), sizeof(kFastaIndexMagic) + 2 * sizeof(uint64_t) + i * sizeof(r));
+   Start = r[0];
+   End = r[2];
+}
+
+inline uint64_t FastaIndexFile::GetObjSummary(const string& What) const{
+   if (What.compare("TotSeq") == 0)
+      return NumOfSeq;
+   else if (What.compare("FileSize") == 0)
+      return FileSize;
+   return 0;
+}
+
+
+/*!
+ * MakeFastaIndex function fills Idx for the fasta file File: from Index
+ * (a .fai or a file written by Save) if it exists, else from File.fai if
+ * no Index is named and that exists, else by a scan, which is saved to
+ * Index when one is named.
+ * @param File [const string&]
+ * @param Index [const string&] // may be empty
+ * @param Idx [FastaIndex&]
+ */
+inline void MakeFastaIndex(const string& File, const string& Index, FastaIndex& Idx){
+   string fai = File + ".fai";
+   if (Index.size() > 0 && ifstream(Index.c_str()).good()){
+      if (Index.size() > 4 && Index.compare(Index.size()-4, 4, ".fai") == 0)
+         Idx.ReadFai(Index, File);
+      else
+         Idx.Load(Index);
+      struct stat st;
+      if (stat(File.c_str(), &st) != 0)
+         throw runtime_error ("Cannot open file: " + File );
+      if (Idx.GetObjSummary("FileSize") != (uint64_t) st.st_size)
+         throw runtime_error ("Index " + Index + " does not match " + File );
+   }else if (Index.size() == 0 && ifstream(fai.c_str()).good()){
+      Idx.ReadFai(fai, File);
+   }else{
+      Idx.Scan(File);
+      if (Index.size() > 0)
+         Idx.Save(Index);
+   }
+}
+
+
+inline uint64_t FastaIndex::GetObjSummary(const string& What) const{
+   if (What.compare("TotSeq") == 0)
+      return Recs.size();
+   else if (What.compare("TotSize") == 0){
+      uint64_t n = 0;
+      for (size_t i = 0; i < Recs.size(); i++)
+         n += Recs[i].residues;
+      return n;
+   }else if (What.compare("FileSize") == 0)
+      return FileSize;
+   return 0;
+}
+
+}
+
+#endif
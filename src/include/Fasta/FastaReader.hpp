@@ -0,0 +1,120 @@
+/*
+ * FastaReader.hpp
+ *
+ * Copyright 2016 Robert Bakaric <rbakaric@irb.hr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+
+#ifndef FASTAPLUS_FASTA_FASTAREADER_HPP
+#define FASTAPLUS_FASTA_FASTAREADER_HPP
+
+#include <fstream>
+#include <string>
+#include <stdexcept>
+
+/** @file FastaReader.hpp
+ * Record by record reading of (multi)fasta files
+ */
+
+using namespace std;
+
+namespace fastaplus {
+
+/**
+ * @brief Streaming fasta reader. Unlike Fasta, which loads a whole file,
+ * it holds only the record being read.
+ */
+class FastaReader {
+
+   ifstream fs;
+   string   line;           /* header line of the next record */
+   bool     pending;        /* line holds an unread header */
+   unsigned long NumOfSeq;
+
+   public:
+
+/*!
+ * FastaReader class constructor.
+ * @param File [const string&]
+ */
+   FastaReader(const string& File);
+
+/*!
+ * FastaReader class destructor.
+ */
+   ~FastaReader();
+
+/*!
+ * Next function reads the next record. Lines before the first header are
+ * skipped; sequence lines are concatenated as they are.
+ * Returns false at the end of the file.
+ * @param Cap [string&] // header line without '>'
+ * @param Corp [string&] // raw sequence
+ */
+   bool Next(string& Cap, string& Corp);
+
+/*!
+ * Object data getter. \n
+ * Getter retrieves the number of records read so far ("TotSeq").
+ * @param What [const string&]
+ */
+   unsigned long GetObjSummary(const string& What);
+};
+
+
+inline FastaReader::FastaReader(const string& File):pending(false),NumOfSeq(0){
+   fs.open(File.c_str(), ios::in);
+   if ( !fs.is_open())
+      throw runtime_error ("Cannot open file: " + File );
+}
+
+inline FastaReader::~FastaReader(){
+   fs.close();
+}
+
+inline bool FastaReader::Next(string& Cap, string& Corp){
+   while (!pending){
+      if (!getline(fs, line))
+         return false;
+      pending = (line.size() > 0 && line[0] == '>');
+   }
+
+   Cap.assign(line, 1, string::npos);
+   Corp.clear();
+   pending = false;
+   while (getline(fs, line)){
+      if (line.size() > 0 && line[0] == '>'){
+         pending = true;
+         break;
+      }
+      Corp += line;
+   }
+   NumOfSeq++;
+   return true;
+}
+
+inline unsigned long FastaReader::GetObjSummary(const string& What){
+   if (What.compare("TotSeq") == 0)
+      return NumOfSeq;
+   return 0;
+}
+
+}
+
+#endif
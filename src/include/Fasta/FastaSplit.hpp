@@ -0,0 +1,194 @@
+/*
+ * FastaSplit.hpp
+ *
+ * Copyright 2016 Robert Bakaric <rbakaric@irb.hr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+
+#ifndef FASTAPLUS_FASTA_FASTASPLIT_HPP
+#define FASTAPLUS_FASTA_FASTASPLIT_HPP
+
+#include <string>
+#include <unordered_map>
+#include <Fasta/FastaReader.hpp>
+#include <Fasta/FastaCap.hpp>
+#include <Fasta/FastaCorp.hpp>
+#include <Utility/ShardWriter.hpp>
+
+/** @file FastaSplit.hpp
+ * Streaming split of (multi)fasta files by taxon.
+ */
+
+using namespace std;
+
+namespace fastaplus {
+
+/**
+ * @brief Routes records to one file per taxonomy identifier in a single
+ * pass, through a ShardWriter, so that the number of taxa is not bound
+ * by the number of open files.
+ *
+ * Records with an indexed header (si|...|ti|...|ss|...) keep it unchanged
+ * and go to the file of their ti. Raw headers are indexed as Fasta does
+ * when loading with the default TaxId, keeping the text up to the first
+ * tab as DmpFastaAll does. Sequences are cleaned and written in lines of
+ * 80, so every file holds what DmpFastaAll(File, TaxId) writes.
+ *
+ * @par Example:
+ * @code
+ * TaxonSplitter Split("out.", "1");
+ * Split.Split("proteomes.fa");   // out.9606, out.10090, ...
+ * Split.Close();
+ * @endcode
+ */
+class TaxonSplitter {
+
+   ShardWriter Out;
+   string Prefix;
+   string TaxId;                             /* taxon of raw headers */
+   unordered_map<string, size_t> Shard;      /* taxon -> shard */
+   unsigned long NumOfSeq;
+   string Rec;                               /* record being formatted */
+
+   public:
+
+/*!
+ * TaxonSplitter class constructor.
+ * @param prefix [const string&] // the file of taxon T is prefix + T
+ * @param taxid [const string&] // taxon of records with a raw header
+ * @param maxopen [size_t] // open files at most
+ * @param budget [size_t] // buffered bytes at most
+ */
+   TaxonSplitter(const string& prefix, const string& taxid, size_t maxopen = 256, size_t budget = 1 << 26);
+
+/*!
+ * TaxonSplitter class destructor.
+ */
+   ~TaxonSplitter();
+
+/*!
+ * TaxonOf function finds the ti field of an indexed header. Returns
+ * false for a raw header.
+ * @param Cap [const string&] // without '>'
+ * @param Ti [string&] // the ti field, possibly empty
+ */
+   static bool TaxonOf(const string& Cap, string& Ti);
+
+/*!
+ * Add function routes one record.
+ * @param Cap [const string&] // header without '>'
+ * @param Corp [string&] // sequence, cleaned in place
+ */
+   void Add(const string& Cap, string& Corp);
+
+/*!
+ * Split function routes all records of a file.
+ * @param File [const string&]
+ */
+   void Split(const string& File);
+
+/*!
+ * Close function writes out and closes all files.
+ */
+   void Close();
+
+/*!
+ * Object data getter. \n
+ * Getter retrieves the number of records ("TotSeq") and taxa ("Taxa").
+ * @param What [const string&]
+ */
+   unsigned long GetObjSummary(const string& What);
+
+};
+
+
+/* Constructors */
+inline TaxonSplitter::TaxonSplitter(const string& prefix, const string& taxid, size_t maxopen, size_t budget)
+   :Out(prefix, maxopen, budget), Prefix(prefix), TaxId(taxid), NumOfSeq(0){}
+
+/* Destructors */
+inline TaxonSplitter::~TaxonSplitter(){}
+
+
+/* Functions  : Public */
+
+inline bool TaxonSplitter::TaxonOf(const string& Cap, string& Ti){
+   if (Cap.compare(0, 3, "si|") != 0)
+      return false;
+   size_t b = Cap.find("|ti|");
+   size_t t = Cap.find('\t');
+   if (b == string::npos || b > t)
+      return false;
+   b += 4;
+   Ti = Cap.substr(b, Cap.find('|', b) - b);
+   return true;
+}
+
+inline void TaxonSplitter::Add(const string& Cap, string& Corp){
+   string ti;
+   NumOfSeq++;
+
+   Rec = ">";
+   if (TaxonOf(Cap, ti)){
+      Rec += Cap;
+   }else{
+      ti = TaxId;
+      Rec += FormatCap(Cap.substr(0, Cap.find('\t')), TaxId, NumOfSeq, "0");
+   }
+   Rec += '\n';
+   CleanCorp(Corp);
+   for (size_t i = 0; i < Corp.size(); i += 80){
+      Rec.append(Corp, i, 80);
+      Rec += '\n';
+   }
+
+   unordered_map<string, size_t>::iterator it = Shard.find(ti);
+   if (it == Shard.end()){
+      string name(ti);
+      for (size_t i = 0; i < name.size(); i++)
+         if (name[i] == '/')
+            name[i] = '_';
+      it = Shard.insert(make_pair(ti, Shard.size())).first;
+      Out.SetPath(it->second, Prefix + name);
+   }
+   Out.Write(it->second, Rec.data(), Rec.size());
+}
+
+inline void TaxonSplitter::Split(const string& File){
+   FastaReader Reader(File);
+   string cap, corp;
+   while (Reader.Next(cap, corp))
+      Add(cap, corp);
+}
+
+inline void TaxonSplitter::Close(){
+   Out.Close();
+}
+
+inline unsigned long TaxonSplitter::GetObjSummary(const string& What){
+   if (What.compare("TotSeq") == 0)
+      return NumOfSeq;
+   else if (What.compare("Taxa") == 0)
+      return Shard.size();
+   return 0;
+}
+
+}
+
+#endif
@@ -0,0 +1,425 @@
+/*
+ * DUST.hpp
+ *
+ * Copyright 2016 Robert Bakaric <rbakaric@irb.hr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+
+
+ /* NOTE:
+  *
+  * This filter implements the symmetric DUST algorithm:
+  *
+  *    Morgulis, A., Gertz, E.M., Schaffer, A.A., Agarwala, R. (2006)
+  *    A fast and symmetric DUST implementation to mask low-complexity
+  *    DNA sequences. Journal of Computational Biology 13: 1028-1040.
+  *
+  * The window/perfect interval bookkeeping follows the sdust
+  * implementation shipped with minimap2 (H. Li), variable names are kept
+  * close to it (L, rw, rv, cw, cv, P).
+  *
+  * */
+
+#ifndef FASTAPLUS_FILTERS_DUST_HPP
+#define FASTAPLUS_FILTERS_DUST_HPP
+
+#include <vector>
+#include <string>
+#include <cstring>
+#include <stdexcept>
+#include <unordered_map>
+#include <Filters/Interval.hpp>
+#include <Utility/Alphabet.hpp>
+#include <Utility/ConvertString.hpp>
+
+
+using namespace std;
+
+namespace fastaplus {
+
+/**
+ * @brief Symmetric DUST nucleotide sequence filter.
+ */
+template <typename Tint>
+class DUST {
+
+/* Globals */
+   Tint  Window;                 /* W: window length */
+   Tint  Level;                  /* T: score threshold (x10) */
+   char  subchar;                /* 0: lower case */
+
+/* Tables */
+   static const Tint kWordLen = 3;             /* triplets */
+   static const Tint kWords   = 64;            /* 4^kWordLen */
+   static const unsigned char kOther = DNA4::Other;  /* non ACGT code */
+   typedef AlphabetLut<DNA4> Lut;              /* ACGTacgt -> 0..3, else kOther */
+
+   struct PerfIntv{
+      Tint start;                /* first base */
+      Tint finish;               /* one past the last base */
+      Tint r;                    /* score */
+      Tint l;                    /* number of triplets */
+   };
+
+   public:
+
+/**
+ * @brief Per call working memory. A Buffer may be reused across
+ * sequences to avoid reallocation, but not shared between threads.
+ */
+   struct Buffer{
+      vector<unsigned char> enc;     /* encoded sequence (string overloads) */
+      vector<unsigned char> w;       /* triplets of the current window (mirrored ring) */
+      Tint front;
+      Tint count;
+      vector<PerfIntv> P;            /* sorted by descending start, ascending finish */
+      vector<Interval<Tint>> res;
+   };
+
+   private:
+
+   template<typename Targ>
+   void  SetParamaters(Targ& arg);
+   Tint  At(const Buffer& b, Tint i) const;
+   void  ShiftWindow(Buffer& b, Tint t, Tint& L, Tint& rw, Tint& rv, Tint* cw, Tint* cv) const;
+   void  SaveMasked(Buffer& b, Tint start) const;
+   void  FindPerfect(Buffer& b, Tint start, Tint L, Tint rv, const Tint* cv) const;
+
+   public:
+
+/*!
+ * DUST class constructor. \n
+ * Parameters: dust_window (64), dust_level (20), dust_subchar (N, empty for lower case)
+ * @param arg [unordered_map<string,string>&]
+ */
+   template <typename Targ>
+   DUST(Targ& arg);
+/*!
+ * DUST class default constructor.
+ */
+   DUST();
+
+/*!
+ * DUST class destructor.
+ */
+   ~DUST();
+
+/*!
+ * Filter function identifies and masks (nNn) low complexity segments.
+ * @param str [const string&] // DNA sequence
+ */
+   string Filter(const string& str) const;
+
+/*!
+ * FilterInPlace function masks (nNn) low complexity segments of a given sequence.
+ * @param str [string&] // DNA sequence
+ */
+   void FilterInPlace(string& str) const;
+
+/*!
+ * Mask function returns the low complexity segments as a list of sorted closed intervals.
+ * @param str [const string&] // DNA sequence
+ */
+   vector<Interval<Tint>> Mask(const string& str) const;
+
+/*!
+ * Mask function overload reusing the working memory of a given buffer.
+ * @param str [const string&] // DNA sequence
+ * @param buf [Buffer&]
+ */
+   const vector<Interval<Tint>>& Mask(const string& str, Buffer& buf) const;
+
+/*!
+ * Mask function overload working on a sequence already translated by Encode.
+ * @param enc [const unsigned char*] // base codes
+ * @param n [Tint] // sequence length
+ * @param buf [Buffer&]
+ */
+   const vector<Interval<Tint>>& Mask(const unsigned char* enc, Tint n, Buffer& buf) const;
+
+/*!
+ * Apply function masks (nNn) the given intervals of a sequence in place.
+ * @param str [string&] // DNA sequence
+ * @param ivs [const vector<Interval<Tint>>&]
+ */
+   void Apply(string& str, const vector<Interval<Tint>>& ivs) const;
+
+/*!
+ * Encode function translates a sequence into base codes (ACGT -> 0..3, else 4).
+ * @param str [const string&] // DNA sequence
+ * @param enc [vector<unsigned char>&] // resized to the sequence length
+ */
+   void Encode(const string& str, vector<unsigned char>& enc) const;
+
+/*!
+ * CodeOf function returns the base code of a single character.
+ * @param c [char]
+ */
+   unsigned char CodeOf(char c) const;
+
+/*!
+ * Signature function returns the parameters that determine Mask, as a
+ * string (used to key cached results, see MaskCache).
+ */
+   string Signature() const;
+
+/*!
+ * MaskBits function returns low complexity positions as a per position mask.
+ * @param str [const string&] // DNA sequence
+ */
+   vector<bool> MaskBits(const string& str) const;
+
+};
+
+
+
+/* Constructors */
+template <typename Tint>
+DUST<Tint>::DUST(){
+   unordered_map<string,string> para;
+   SetParamaters(para);
+}
+
+template <typename Tint>
+template <typename Targ>
+DUST<Tint>::DUST(Targ& arg){
+   SetParamaters(arg);
+}
+
+/* Destructors */
+template <typename Tint>
+DUST<Tint>::~DUST(){}
+
+
+/* Functions  : Public */
+
+template <typename Tint>
+string DUST<Tint>::Filter(const string& str) const{
+   string masked(str);
+   FilterInPlace(masked);
+   return masked;
+}
+
+template <typename Tint>
+void DUST<Tint>::FilterInPlace(string& str) const{
+   Buffer buf;
+   Apply(str, Mask(str, buf));
+}
+
+template <typename Tint>
+void DUST<Tint>::Apply(string& str, const vector<Interval<Tint>>& ivs) const{
+   ApplyMask(str, ivs, subchar);
+}
+
+template <typename Tint>
+void DUST<Tint>::Encode(const string& str, vector<unsigned char>& enc) const{
+   Lut::Encode(str, enc);
+}
+
+template <typename Tint>
+unsigned char DUST<Tint>::CodeOf(char c) const{
+   return Lut::code[(unsigned char) c];
+}
+
+template <typename Tint>
+string DUST<Tint>::Signature() const{
+   return "DUST/" + NumericToString(Window) + "/" + NumericToString(Level);
+}
+
+template <typename Tint>
+vector<Interval<Tint>> DUST<Tint>::Mask(const string& str) const{
+   Buffer buf;
+   return Mask(str, buf);
+}
+
+template <typename Tint>
+vector<bool> DUST<Tint>::MaskBits(const string& str) const{
+   Buffer buf;
+   return IntervalsToBits(Mask(str, buf), str.size());
+}
+
+template <typename Tint>
+const vector<Interval<Tint>>& DUST<Tint>::Mask(const string& str, Buffer& buf) const{
+   Encode(str, buf.enc);
+   return Mask(buf.enc.data(), str.size(), buf);
+}
+
+template <typename Tint>
+const vector<Interval<Tint>>& DUST<Tint>::Mask(const unsigned char* enc, Tint n, Buffer& buf) const{
+   Tint rv = 0, rw = 0, L = 0, cv[kWords], cw[kWords];
+   Tint i, start, l;          /* start: of the current window; l: length of an ACGT run */
+   unsigned t;                /* current triplet */
+
+   buf.w.resize(2*(Window - kWordLen + 1));
+   buf.front = buf.count = 0;
+   buf.P.clear();
+   buf.res.clear();
+
+   memset(cv, 0, sizeof(cv));
+   memset(cw, 0, sizeof(cw));
+
+   for (i = l = t = 0; i <= n; ++i){
+      Tint b = i < n ? (Tint) enc[i] : (Tint) kOther;
+      if (b < kOther){
+         ++l;
+         t = (t<<2 | b) & (kWords-1);
+         if (l >= kWordLen){
+            start = (l - Window > 0 ? l - Window : 0) + (i + 1 - l);
+            SaveMasked(buf, start);
+            ShiftWindow(buf, t, L, rw, rv, cw, cv);
+            if (rw * 10 > L * Level)
+               FindPerfect(buf, start, L, rv, cv);
+         }
+      }else{
+/* N (or the end) splits the sequence into independent pieces; flush
+ * from the window start following the last one, so no interval is skipped */
+         start = (l - Window > 0 ? l - Window : 0) + (i + 1 - l);
+         while (!buf.P.empty())
+            SaveMasked(buf, start++);
+         l = t = 0;
+         rv = rw = L = 0;
+         buf.front = buf.count = 0;
+         memset(cv, 0, sizeof(cv));
+         memset(cw, 0, sizeof(cw));
+      }
+   }
+   return buf.res;
+}
+
+
+/* Functions  : Private */
+
+template <typename Tint>
+template <typename Targ>
+void DUST<Tint>::SetParamaters(Targ& arg){
+   Window  = (arg.find("dust_window") != arg.end()) ? StringToNumeric<Tint>(arg["dust_window"]) : 64;
+   Level   = (arg.find("dust_level") != arg.end())  ? StringToNumeric<Tint>(arg["dust_level"])  : 20;
+   subchar = (arg.find("dust_subchar") != arg.end()) ? arg["dust_subchar"][0] : 'N';
+
+   if (Window <= kWordLen)
+      throw runtime_error ("DUST window has to be longer than a triplet!");
+   if (Level <= 0)
+      throw runtime_error ("DUST level has to be positive!");
+}
+
+/* The ring is stored twice in a row, so the window is always the
+ * contiguous range w[front, front+count).
+ */
+template <typename Tint>
+Tint DUST<Tint>::At(const Buffer& b, Tint i) const{
+   return b.w[b.front + i];
+}
+
+/* Move the window by one triplet. rw is the score of the whole window,
+ * rv the score of its suffix of L triplets that contains no triplet
+ * more than 2T/10 times; the suffix is cut back once t exceeds that.
+ */
+template <typename Tint>
+void DUST<Tint>::ShiftWindow(Buffer& b, Tint t, Tint& L, Tint& rw, Tint& rv, Tint* cw, Tint* cv) const{
+   Tint s;
+   Tint cap = b.w.size() / 2;
+
+   if (b.count >= cap){
+      s = b.w[b.front];
+      b.front = (b.front + 1) % cap;
+      --b.count;
+      rw -= --cw[s];
+      if (L > b.count){
+         --L;
+         rv -= --cv[s];
+      }
+   }
+   s = (b.front + b.count) % cap;
+   b.w[s] = b.w[s + cap] = t;
+   ++b.count;
+   ++L;
+   rw += cw[t]++;
+   rv += cv[t]++;
+   if (cv[t] * 10 > Level * 2){
+      do {
+         s = At(b, b.count - L);
+         rv -= --cv[s];
+         --L;
+      } while (s != (Tint) t);
+   }
+}
+
+/* Report the last perfect interval once the window no longer covers its
+ * start and drop all perfect intervals that have fallen out.
+ */
+template <typename Tint>
+void DUST<Tint>::SaveMasked(Buffer& b, Tint start) const{
+   Tint i;
+
+   if (b.P.empty() || b.P.back().start >= start)
+      return;
+
+   const PerfIntv& p = b.P.back();
+   if (!b.res.empty() && p.start <= b.res.back().end + 1){
+      if (b.res.back().end < p.finish - 1)
+         b.res.back().end = p.finish - 1;
+   }else{
+      Interval<Tint> iv = {p.start, p.finish - 1};
+      b.res.push_back(iv);
+   }
+
+   for (i = b.P.size() - 1; i >= 0 && b.P[i].start < start; --i);
+   b.P.resize(i + 1);
+}
+
+/* Scan the suffixes of the window that extend beyond the current
+ * L triplets and record those scoring above T that are not dominated by
+ * an already known perfect interval starting at or after them.
+ */
+template <typename Tint>
+void DUST<Tint>::FindPerfect(Buffer& b, Tint start, Tint L, Tint rv, const Tint* cv) const{
+   Tint c[kWords];
+   Tint r = rv, i, j, max_r = 0, max_l = 0;
+   const unsigned char* win = b.w.data() + b.front;
+
+   memcpy(c, cv, sizeof(c));
+/* starts only decrease with i, so the insertion point j only moves forward */
+   for (i = b.count - L - 1, j = 0; i >= 0; --i){
+      Tint t = win[i];
+      Tint new_r, new_l;
+
+      r += c[t]++;
+      new_r = r;
+      new_l = b.count - i - 1;
+      if (new_r * 10 > Level * new_l){
+         for (; j < (Tint) b.P.size() && b.P[j].start >= i + start; ++j){
+            const PerfIntv& p = b.P[j];
+            if (max_r == 0 || p.r * max_l > max_r * p.l){
+               max_r = p.r;
+               max_l = p.l;
+            }
+         }
+         if (max_r == 0 || new_r * max_l >= max_r * new_l){
+            max_r = new_r;
+            max_l = new_l;
+            PerfIntv p = {i + start, b.count + (kWordLen - 1) + start, new_r, new_l};
+            b.P.insert(b.P.begin() + j, p);
+         }
+      }
+   }
+}
+
+}
+
+#endif
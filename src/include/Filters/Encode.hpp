@@ -0,0 +1,123 @@
+/*
+ * Encode.hpp
+ *
+ * Copyright 2016 Robert Bakaric <rbakaric@irb.hr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+
+#ifndef FASTAPLUS_FILTERS_ENCODE_HPP
+#define FASTAPLUS_FILTERS_ENCODE_HPP
+
+#include <cstddef>
+#include <Utility/CpuFeatures.hpp>
+
+/** @file Encode.hpp
+ * Byte to residue code translation shared by the filters
+ */
+
+namespace fastaplus {
+
+/*!
+ * LutIsLetterOnly function checks whether a 256 entry translation table
+ * maps every byte outside 0x40-0x7f (i.e. outside the letters) to Other.
+ * Only such tables can be used by the SIMD path of EncodeBytes.
+ * @param Lut [const unsigned char*]
+ * @param Other [unsigned char] // code of non residue characters
+ */
+inline bool LutIsLetterOnly(const unsigned char* Lut, unsigned char Other){
+   for (int c=0; c<256; c++)
+      if ((c < 0x40 || c > 0x7f) && Lut[c] != Other)
+         return false;
+   return true;
+}
+
+#if defined(FASTAPLUS_HAVE_SSSE3)
+#if defined(FASTAPLUS_X86_DISPATCH)
+#pragma GCC push_options
+#pragma GCC target("ssse3")
+#endif
+/*!
+ * EncodeBytesSsse3 function translates the first N/16*16 bytes of Src
+ * through a letter only Lut, 16 at a time, and returns their number:
+ * pshufb only indexes 16 entries, so the low nibble selects within each
+ * of the four rows 0x40-0x7f and the high nibble selects the row;
+ * everything else gets Other.
+ * @param Lut [const unsigned char*] // 256 entries, LutIsLetterOnly
+ * @param Other [unsigned char]
+ * @param Src [const unsigned char*]
+ * @param Dst [unsigned char*]
+ * @param N [size_t]
+ */
+inline size_t EncodeBytesSsse3(const unsigned char* Lut, unsigned char Other,
+                               const unsigned char* Src, unsigned char* Dst, size_t N){
+   const __m128i nib = _mm_set1_epi8(0x0f);
+   const __m128i other = _mm_set1_epi8((char) Other);
+   __m128i row[4], hi[4];
+   size_t i = 0;
+
+   for (int k=0; k<4; k++){
+      row[k] = _mm_loadu_si128((const __m128i*) (Lut + 0x40 + 16*k));
+      hi[k] = _mm_set1_epi8((char) (4+k));
+   }
+   for (; i+16<=N; i+=16){
+      __m128i x = _mm_loadu_si128((const __m128i*) (Src+i));
+      __m128i lo = _mm_and_si128(x, nib);
+      __m128i h = _mm_and_si128(_mm_srli_epi16(x, 4), nib);
+      __m128i r = other;
+      for (int k=0; k<4; k++){
+         __m128i m = _mm_cmpeq_epi8(h, hi[k]);
+         r = _mm_or_si128(_mm_andnot_si128(m, r), _mm_and_si128(m, _mm_shuffle_epi8(row[k], lo)));
+      }
+      _mm_storeu_si128((__m128i*) (Dst+i), r);
+   }
+   return i;
+}
+#if defined(FASTAPLUS_X86_DISPATCH)
+#pragma GCC pop_options
+#endif
+#endif
+
+/*!
+ * EncodeBytes function translates N bytes of Src into Dst through Lut.
+ * If LetterOnly is set (see LutIsLetterOnly) and the processor has SSSE3
+ * (see CpuFeatures.hpp), EncodeBytesSsse3 translates 16 bytes at a time.
+ * @param Lut [const unsigned char*] // 256 entries
+ * @param LetterOnly [bool]
+ * @param Other [unsigned char]
+ * @param Src [const unsigned char*]
+ * @param Dst [unsigned char*]
+ * @param N [size_t]
+ */
+inline void EncodeBytes(const unsigned char* Lut, bool LetterOnly, unsigned char Other,
+                        const unsigned char* Src, unsigned char* Dst, size_t N){
+   size_t i = 0;
+#if defined(FASTAPLUS_HAVE_SSSE3)
+   if (LetterOnly && CpuSimdLevel() >= kSsse3)
+      i = EncodeBytesSsse3(Lut, Other, Src, Dst, N);
+#else
+   (void) LetterOnly;
+   (void) Other;
+#endif
+   for (; i<N; i++)
+      Dst[i] = Lut[Src[i]];
+}
+
+}
+
+#endif
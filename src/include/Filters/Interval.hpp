@@ -0,0 +1,109 @@
+/*
+ * Interval.hpp
+ *
+ * Copyright 2016 Robert Bakaric <rbakaric@irb.hr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+
+#ifndef FASTAPLUS_FILTERS_INTERVAL_HPP
+#define FASTAPLUS_FILTERS_INTERVAL_HPP
+
+#include <cctype>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/** @file Interval.hpp
+ * Masked interval representation shared by the low complexity filters
+ */
+
+using namespace std;
+
+namespace fastaplus {
+
+/**
+ * @brief Closed interval [begin, end] of masked sequence positions (0-based).
+ */
+template <typename Tint>
+struct Interval {
+   Tint begin;
+   Tint end;
+};
+
+/*!
+ * IntervalsToBits function expands a list of intervals into a per position mask.
+ * @param Ivs [const vector<Interval<Tint>>&]
+ * @param Len [size_t] // sequence length
+ */
+template <typename Tint>
+vector<bool> IntervalsToBits(const vector<Interval<Tint>>& Ivs, size_t Len){
+   vector<bool> bits(Len, false);
+   for (size_t i = 0; i < Ivs.size(); i++)
+      for (Tint k = Ivs[i].begin; k <= Ivs[i].end; k++)
+         bits[k] = true;
+   return bits;
+}
+
+/*!
+ * UniteIntervals function returns the union of two lists of intervals,
+ * each sorted by begin, as a sorted list of disjoint intervals. Touching
+ * intervals are merged.
+ * @param A [const vector<Interval<Tint>>&]
+ * @param B [const vector<Interval<Tint>>&]
+ */
+template <typename Tint>
+vector<Interval<Tint>> UniteIntervals(const vector<Interval<Tint>>& A, const vector<Interval<Tint>>& B){
+   vector<Interval<Tint>> u;
+   size_t i = 0, j = 0;
+
+   u.reserve(A.size() + B.size());
+   while (i < A.size() || j < B.size()){
+      const Interval<Tint>& iv = (j == B.size() || (i < A.size() && A[i].begin <= B[j].begin)) ? A[i++] : B[j++];
+      if (!u.empty() && iv.begin <= u.back().end + 1){
+         if (u.back().end < iv.end)
+            u.back().end = iv.end;
+      }else{
+         u.push_back(iv);
+      }
+   }
+   return u;
+}
+
+/*!
+ * ApplyMask function masks the given intervals of a sequence in place.
+ * If SubChar is 0, masked characters are converted to lower case instead.
+ * @param Str [string&]
+ * @param Ivs [const vector<Interval<Tint>>&]
+ * @param SubChar [char]
+ */
+template <typename Tint>
+void ApplyMask(string& Str, const vector<Interval<Tint>>& Ivs, char SubChar){
+   for (size_t i = 0; i < Ivs.size(); i++){
+      if (SubChar != 0){
+         memset(&Str[0] + Ivs[i].begin, SubChar, Ivs[i].end - Ivs[i].begin + 1);
+      }else{
+         for (Tint k = Ivs[i].begin; k <= Ivs[i].end; k++)
+            Str[k] = tolower(Str[k]);
+      }
+   }
+}
+
+}
+
+#endif
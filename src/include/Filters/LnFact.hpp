@@ -6,6 +6,9 @@
  */
  
 
+#ifndef FASTAPLUS_FILTERS_LNFACT_HPP
+#define FASTAPLUS_FILTERS_LNFACT_HPP
+
 /* Natural log of factorials: 
  *  0!, 1!, 2!, 3! 
  */
@@ -1266,3 +1269,4 @@ double lnFactA[] =
    82108.927837 
   }; 
 
+#endif
@@ -0,0 +1,274 @@
+/*
+ * MaskCache.hpp
+ *
+ * Copyright 2016 Robert Bakaric <rbakaric@irb.hr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+
+#ifndef FASTAPLUS_FILTERS_MASKCACHE_HPP
+#define FASTAPLUS_FILTERS_MASKCACHE_HPP
+
+#include <list>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <mutex>
+#include <cstring>
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <unordered_map>
+#include <Filters/Interval.hpp>
+#include <Utility/Hash128.hpp>
+
+/** @file MaskCache.hpp
+ * Memo of filter results keyed by a hash of the filter input and
+ * parameters (see FilterPipeline::SetCache).
+ */
+
+using namespace std;
+
+namespace fastaplus {
+
+/**
+ * @brief Bounded, thread safe map from a 128 bit key to a mask.
+ *
+ * Entries are spread over shards by key, each shard is an LRU list under
+ * its own lock, so threads rarely wait for each other. The cache can be
+ * saved to and loaded from a file; keys carry the filter parameters, so
+ * entries stored under other parameters simply never hit.
+ */
+template <typename Tint>
+class MaskCache {
+
+   struct Node{
+      Hash128 key;
+      vector<Interval<Tint>> ivs;
+   };
+
+   struct Shard{
+      mutex lock;
+      list<Node> lru;                                              /* most recent first */
+      unordered_map<Hash128, typename list<Node>::iterator, Hash128Hasher> index;
+   };
+
+   vector<Shard> Shards;
+   size_t ShardCapacity;
+
+/* Counters */
+   atomic<unsigned long> Hits;
+   atomic<unsigned long> Misses;
+
+   Shard& ShardOf(const Hash128& key){ return Shards[key.hi % Shards.size()]; }
+
+   public:
+
+/*!
+ * MaskCache class constructor.
+ * @param Capacity [size_t] // number of masks kept (rounded up to a multiple of NumOfShards)
+ * @param NumOfShards [size_t]
+ */
+   MaskCache(size_t Capacity, size_t NumOfShards = 16);
+
+/*!
+ * MaskCache class destructor.
+ */
+   ~MaskCache();
+
+/*!
+ * Get function copies the mask stored under a key into ivs. Returns false
+ * (leaving ivs untouched) if there is none.
+ * @param key [const Hash128&]
+ * @param ivs [vector<Interval<Tint>>&]
+ */
+   bool Get(const Hash128& key, vector<Interval<Tint>>& ivs);
+
+/*!
+ * Put function stores a mask, evicting the least recently used one of
+ * its shard if the shard is full.
+ * @param key [const Hash128&]
+ * @param ivs [const vector<Interval<Tint>>&]
+ */
+   void Put(const Hash128& key, const vector<Interval<Tint>>& ivs);
+
+/*!
+ * Save function writes all entries to a binary file.
+ * @param File [const string&]
+ */
+   void Save(const string& File);
+
+/*!
+ * Load function reads entries written by Save (up to the capacity).
+ * @param File [const string&]
+ */
+   void Load(const string& File);
+
+/*!
+ * Object data getter. \n
+ * Getter retrieves the number of "Hits", "Misses" and stored "Entries".
+ * @param What [const string&]
+ */
+   unsigned long GetObjSummary(const string& What);
+
+};
+
+
+static const char kMaskCacheMagic[8] = {'F','P','M','C','A','C','H','1'};
+
+
+/* Constructors */
+template <typename Tint>
+MaskCache<Tint>::MaskCache(size_t Capacity, size_t NumOfShards):Shards(NumOfShards ? NumOfShards : 1), Hits(0), Misses(0){
+   ShardCapacity = (Capacity + Shards.size() - 1) / Shards.size();
+   if (ShardCapacity == 0)
+      ShardCapacity = 1;
+}
+
+/* Destructors */
+template <typename Tint>
+MaskCache<Tint>::~MaskCache(){}
+
+
+/* Functions  : Public */
+
+template <typename Tint>
+bool MaskCache<Tint>::Get(const Hash128& key, vector<Interval<Tint>>& ivs){
+   Shard& s = ShardOf(key);
+   lock_guard<mutex> lk(s.lock);
+
+   auto it = s.index.find(key);
+   if (it == s.index.end()){
+      Misses++;
+      return false;
+   }
+   s.lru.splice(s.lru.begin(), s.lru, it->second);
+   ivs = it->second->ivs;
+   Hits++;
+   return true;
+}
+
+template <typename Tint>
+void MaskCache<Tint>::Put(const Hash128& key, const vector<Interval<Tint>>& ivs){
+   Shard& s = ShardOf(key);
+   lock_guard<mutex> lk(s.lock);
+
+   auto it = s.index.find(key);
+   if (it != s.index.end()){
+      it->second->ivs = ivs;
+      s.lru.splice(s.lru.begin(), s.lru, it->second);
+      return;
+   }
+   if (s.lru.size() >= ShardCapacity){
+      s.index.erase(s.lru.back().key);
+      s.lru.pop_back();
+   }
+   Node node = {key, ivs};
+   s.lru.push_front(node);
+   s.index[key] = s.lru.begin();
+}
+
+/* Layout: magic, sizeof(Tint), then per entry key.lo, key.hi, the number
+ * of intervals and their begin/end pairs, least recently used first so
+ * that loading restores the order.
+ */
+template <typename Tint>
+void MaskCache<Tint>::Save(const string& File){
+   ofstream fs(File.c_str(), ios::out | ios::binary);
+   if ( !fs.is_open())
+      throw runtime_error ("Cannot open file: " + File );
+
+   uint32_t width = sizeof(Tint);
+   fs.write(kMaskCacheMagic, sizeof(kMaskCacheMagic));
+   fs.write((const char*) &width, sizeof(width));
+
+   for (size_t i = 0; i < Shards.size(); i++){
+      lock_guard<mutex> lk(Shards[i].lock);
+      for (auto it = Shards[i].lru.rbegin(); it != Shards[i].lru.rend(); ++it){
+         uint64_t n = it->ivs.size();
+         fs.write((const char*) &it->key.lo, sizeof(uint64_t));
+         fs.write((const char*) &it->key.hi, sizeof(uint64_t));
+         fs.write((const char*) &n, sizeof(n));
+         for (size_t k = 0; k < it->ivs.size(); k++){
+            fs.write((const char*) &it->ivs[k].begin, sizeof(Tint));
+            fs.write((const char*) &it->ivs[k].end, sizeof(Tint));
+         }
+      }
+   }
+   if (!fs)
+      throw runtime_error ("Cannot write file: " + File );
+}
+
+template <typename Tint>
+void MaskCache<Tint>::Load(const string& File){
+   ifstream fs(File.c_str(), ios::in | ios::binary);
+   if ( !fs.is_open())
+      throw runtime_error ("Cannot open file: " + File );
+
+   char magic[sizeof(kMaskCacheMagic)];
+   uint32_t width = 0;
+   fs.read(magic, sizeof(magic));
+   fs.read((char*) &width, sizeof(width));
+   if (!fs || memcmp(magic, kMaskCacheMagic, sizeof(magic)) != 0 || width != sizeof(Tint))
+      throw runtime_error ("Not a mask cache file: " + File );
+
+/* n is bounded by what is left of the file before anything is allocated */
+   streamoff here = fs.tellg();
+   fs.seekg(0, ios::end);
+   streamoff size = fs.tellg();
+   fs.seekg(here);
+
+   Hash128 key;
+   uint64_t n;
+   vector<Interval<Tint>> ivs;
+   while (fs.read((char*) &key.lo, sizeof(uint64_t))){
+      fs.read((char*) &key.hi, sizeof(uint64_t));
+      fs.read((char*) &n, sizeof(n));
+      if (!fs || n > (uint64_t) (size - fs.tellg()) / (2*sizeof(Tint)))
+         throw runtime_error ("Truncated mask cache file: " + File );
+      ivs.resize(n);
+      for (size_t k = 0; k < n && fs; k++){
+         fs.read((char*) &ivs[k].begin, sizeof(Tint));
+         fs.read((char*) &ivs[k].end, sizeof(Tint));
+      }
+      if (!fs)
+         throw runtime_error ("Truncated mask cache file: " + File );
+      Put(key, ivs);
+   }
+}
+
+template <typename Tint>
+unsigned long MaskCache<Tint>::GetObjSummary(const string& What){
+   if (What.compare("Hits") == 0)
+      return Hits;
+   else if (What.compare("Misses") == 0)
+      return Misses;
+   else if (What.compare("Entries") == 0){
+      unsigned long n = 0;
+      for (size_t i = 0; i < Shards.size(); i++){
+         lock_guard<mutex> lk(Shards[i].lock);
+         n += Shards[i].lru.size();
+      }
+      return n;
+   }
+   return 0;
+}
+
+}
+
+#endif
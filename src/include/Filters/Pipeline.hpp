@@ -0,0 +1,412 @@
+/*
+ * Pipeline.hpp
+ *
+ * Copyright 2016 Robert Bakaric <rbakaric@irb.hr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+
+#ifndef FASTAPLUS_FILTERS_PIPELINE_HPP
+#define FASTAPLUS_FILTERS_PIPELINE_HPP
+
+#include <vector>
+#include <string>
+#include <stdexcept>
+#include <unordered_map>
+#include <Filters/Interval.hpp>
+#include <Filters/SEG.hpp>
+#include <Filters/XNU.hpp>
+#include <Filters/DUST.hpp>
+#include <Filters/MaskCache.hpp>
+#include <Utility/Hash128.hpp>
+
+
+using namespace std;
+
+namespace fastaplus {
+
+/**
+ * @brief Chains of low complexity filters over one sequence.
+ *
+ * A chain names filters (SEG, XNU, DUST) joined by '+' or '|':
+ *
+ *    "SEG+XNU"  XNU runs on the sequence already masked by SEG
+ *    "SEG|XNU"  XNU runs on the original sequence, masks are united
+ *
+ * Every filter translates the sequence into its residue codes once per
+ * sequence. A filter following '+' reuses those codes and only rewrites
+ * the positions masked so far. Each filter result is cached under the
+ * chain that produced its input, so "SEG", "XNU" and "SEG+XNU" cost one
+ * SEG run and two XNU runs.
+ *
+ * With a MaskCache (SetCache) a filter whose input codes and parameters
+ * were seen before, in this or any other pipeline sharing the cache, is
+ * not run at all.
+ */
+template <typename Tint>
+class FilterPipeline {
+
+   enum Stage { kSeg = 0, kXnu = 1, kDust = 2, kStages = 3 };
+
+   struct Step{
+      Stage stage;
+      bool  chained;             /* '+': input is the output of the steps before */
+   };
+
+   struct Entry{
+      unsigned long gen;         /* sequence the mask belongs to */
+      vector<Interval<Tint>> ivs;
+   };
+
+/* Filters */
+   const SEG<Tint>*  Seg;
+   const XNU<Tint>*  Xnu;
+   const DUST<Tint>* Dust;
+
+/* Current sequence */
+   string Seq;
+   unsigned long Generation;
+   vector<unsigned char> Enc[kStages];         /* codes of Seq per filter */
+   bool HaveEnc[kStages];
+
+/* Working memory */
+   unordered_map<string, Entry> Cache;         /* filter masks keyed by their input chain */
+   vector<unsigned char> Work;                 /* codes of a chained input */
+   typename XNU<Tint>::Scratch XnuScratch;
+   typename DUST<Tint>::Buffer DustBuffer;
+
+/* Memo shared across pipelines */
+   MaskCache<Tint>* Memo;
+   uint64_t Seed[kStages];                     /* hash of the filter signature */
+
+/* Counters */
+   unsigned long Runs[kStages];
+
+   void Init();
+   vector<Step> Parse(const string& chain);
+   static vector<Step> ParseChain(const string& chain, bool dust);
+   const char* Name(Stage st);
+   const vector<unsigned char>& Encoded(Stage st);
+   void EncodeStage(Stage st, const string& str, vector<unsigned char>& enc);
+   unsigned char CodeOf(Stage st, char c);
+   void RunStage(Stage st, const unsigned char* enc, Tint n, vector<Interval<Tint>>& ivs);
+   void ApplyStage(Stage st, string& str, const vector<Interval<Tint>>& ivs);
+   void Evaluate(const string& chain, string* out, vector<Interval<Tint>>* all);
+   void Compute(Stage st, const unsigned char* enc, Tint n, vector<Interval<Tint>>& ivs);
+
+   public:
+
+/*!
+ * FilterPipeline class constructor. The filters are referenced, not
+ * copied, and may be shared with pipelines in other threads.
+ * @param seg [const SEG<Tint>&]
+ * @param xnu [const XNU<Tint>&]
+ */
+   FilterPipeline(const SEG<Tint>& seg, const XNU<Tint>& xnu);
+
+/*!
+ * FilterPipeline class constructor overload including DUST.
+ * @param seg [const SEG<Tint>&]
+ * @param xnu [const XNU<Tint>&]
+ * @param dust [const DUST<Tint>&]
+ */
+   FilterPipeline(const SEG<Tint>& seg, const XNU<Tint>& xnu, const DUST<Tint>& dust);
+
+/*!
+ * FilterPipeline class destructor.
+ */
+   ~FilterPipeline();
+
+/*!
+ * SetCache function makes the pipeline look up filter results in a
+ * cache (which may be shared by pipelines in other threads) before
+ * running a filter, and store them there afterwards.
+ * @param cache [MaskCache<Tint>*] // NULL switches caching off
+ */
+   void SetCache(MaskCache<Tint>* cache);
+
+/*!
+ * SetSequence function sets the sequence all following calls work on and
+ * drops the results cached for the previous one.
+ * @param str [const string&]
+ */
+   void SetSequence(const string& str);
+
+/*!
+ * Filter function returns the sequence masked by a chain of filters.
+ * @param chain [const string&] // e.g. "SEG", "SEG+XNU", "SEG|DUST"
+ */
+   string Filter(const string& chain);
+
+/*!
+ * Mask function returns the union of the masks of a chain of filters as a
+ * list of sorted disjoint intervals.
+ * @param chain [const string&]
+ */
+   vector<Interval<Tint>> Mask(const string& chain);
+
+/*!
+ * Validate function checks the syntax of a chain without running any
+ * filter and throws runtime_error for a bad one.
+ * @param chain [const string&]
+ * @param dust [bool] // whether the pipeline will include DUST
+ */
+   static void Validate(const string& chain, bool dust);
+
+/*!
+ * Run summary getter. \n
+ * Getter retrieves the number of "SEG", "XNU" and "DUST" runs (not
+ * counting results taken from the cache).
+ * @param What [const string&]
+ */
+   unsigned long GetRunSummary(const string& What);
+
+};
+
+
+
+/* Constructors */
+template <typename Tint>
+FilterPipeline<Tint>::FilterPipeline(const SEG<Tint>& seg, const XNU<Tint>& xnu):Seg(&seg), Xnu(&xnu), Dust(NULL){
+   Init();
+}
+
+template <typename Tint>
+FilterPipeline<Tint>::FilterPipeline(const SEG<Tint>& seg, const XNU<Tint>& xnu, const DUST<Tint>& dust):Seg(&seg), Xnu(&xnu), Dust(&dust){
+   Init();
+}
+
+/* Destructors */
+template <typename Tint>
+FilterPipeline<Tint>::~FilterPipeline(){}
+
+
+/* Functions  : Public */
+
+template <typename Tint>
+void FilterPipeline<Tint>::SetCache(MaskCache<Tint>* cache){
+   Memo = cache;
+}
+
+template <typename Tint>
+void FilterPipeline<Tint>::SetSequence(const string& str){
+   Seq.assign(str);
+   Generation++;
+   for (int i=0; i<kStages; i++)
+      HaveEnc[i] = false;
+}
+
+template <typename Tint>
+string FilterPipeline<Tint>::Filter(const string& chain){
+   string out;
+   Evaluate(chain, &out, NULL);
+   return out;
+}
+
+template <typename Tint>
+vector<Interval<Tint>> FilterPipeline<Tint>::Mask(const string& chain){
+   vector<Interval<Tint>> all;
+   Evaluate(chain, NULL, &all);
+   return all;
+}
+
+template <typename Tint>
+unsigned long FilterPipeline<Tint>::GetRunSummary(const string& What){
+   for (int i=0; i<kStages; i++)
+      if (What.compare(Name((Stage) i)) == 0)
+         return Runs[i];
+   return 0;
+}
+
+template <typename Tint>
+void FilterPipeline<Tint>::Validate(const string& chain, bool dust){
+   ParseChain(chain, dust);
+}
+
+
+/* Functions  : Private */
+
+template <typename Tint>
+void FilterPipeline<Tint>::Init(){
+   Generation = 1;               /* new cache entries start at 0, i.e. stale */
+   Memo = NULL;
+   Seed[kSeg] = HashString(Seg->Signature()).lo;
+   Seed[kXnu] = HashString(Xnu->Signature()).lo;
+   Seed[kDust] = (Dust != NULL) ? HashString(Dust->Signature()).lo : 0;
+   for (int i=0; i<kStages; i++){
+      HaveEnc[i] = false;
+      Runs[i] = 0;
+   }
+}
+
+template <typename Tint>
+const char* FilterPipeline<Tint>::Name(Stage st){
+   static const char* kNames[kStages] = {"SEG", "XNU", "DUST"};
+   return kNames[st];
+}
+
+template <typename Tint>
+vector<typename FilterPipeline<Tint>::Step> FilterPipeline<Tint>::Parse(const string& chain){
+   return ParseChain(chain, Dust != NULL);
+}
+
+template <typename Tint>
+vector<typename FilterPipeline<Tint>::Step> FilterPipeline<Tint>::ParseChain(const string& chain, bool dust){
+   vector<Step> steps;
+   size_t b = 0;
+   bool chained = false;
+
+   for (size_t i=0; i<=chain.size(); i++){
+      if (i < chain.size() && chain[i] != '+' && chain[i] != '|')
+         continue;
+
+      string name = chain.substr(b, i-b);
+      Step step;
+      if (name.compare("SEG") == 0)
+         step.stage = kSeg;
+      else if (name.compare("XNU") == 0)
+         step.stage = kXnu;
+      else if (name.compare("DUST") == 0)
+         step.stage = kDust;
+      else
+         throw runtime_error ("Unknown filter in chain: " + chain);
+      if (step.stage == kDust && !dust)
+         throw runtime_error ("DUST is not part of the pipeline!");
+
+      step.chained = chained && !steps.empty();
+      steps.push_back(step);
+      if (i < chain.size())
+         chained = (chain[i] == '+');
+      b = i+1;
+   }
+   return steps;
+}
+
+template <typename Tint>
+const vector<unsigned char>& FilterPipeline<Tint>::Encoded(Stage st){
+   if (!HaveEnc[st]){
+      EncodeStage(st, Seq, Enc[st]);
+      HaveEnc[st] = true;
+   }
+   return Enc[st];
+}
+
+template <typename Tint>
+void FilterPipeline<Tint>::EncodeStage(Stage st, const string& str, vector<unsigned char>& enc){
+   switch (st){
+      case kSeg:  Seg->Encode(str, enc);  break;
+      case kXnu:  Xnu->Encode(str, enc);  break;
+      default:    Dust->Encode(str, enc); break;
+   }
+}
+
+template <typename Tint>
+unsigned char FilterPipeline<Tint>::CodeOf(Stage st, char c){
+   switch (st){
+      case kSeg:  return Seg->CodeOf(c);
+      case kXnu:  return Xnu->CodeOf(c);
+      default:    return Dust->CodeOf(c);
+   }
+}
+
+template <typename Tint>
+void FilterPipeline<Tint>::RunStage(Stage st, const unsigned char* enc, Tint n, vector<Interval<Tint>>& ivs){
+   Runs[st]++;
+   switch (st){
+      case kSeg:  ivs = Seg->Mask(enc, n);                 break;
+      case kXnu:  ivs = Xnu->Mask(enc, n, XnuScratch);     break;
+      default:    ivs = Dust->Mask(enc, n, DustBuffer);    break;
+   }
+}
+
+template <typename Tint>
+void FilterPipeline<Tint>::ApplyStage(Stage st, string& str, const vector<Interval<Tint>>& ivs){
+   switch (st){
+      case kSeg:  Seg->Apply(str, ivs);  break;
+      case kXnu:  Xnu->Apply(str, ivs);  break;
+      default:    Dust->Apply(str, ivs); break;
+   }
+}
+
+/* Filter results depend only on the input codes and the filter
+ * parameters, which is what the memo key is made of.
+ */
+template <typename Tint>
+void FilterPipeline<Tint>::Compute(Stage st, const unsigned char* enc, Tint n, vector<Interval<Tint>>& ivs){
+   if (Memo == NULL){
+      RunStage(st, enc, n, ivs);
+      return;
+   }
+   Hash128 key = HashBytes(enc, n, Seed[st]);
+   if (!Memo->Get(key, ivs)){
+      RunStage(st, enc, n, ivs);
+      Memo->Put(key, ivs);
+   }
+}
+
+/* The input of a chained step is the sequence rendered by the steps
+ * before it. SEG and DUST only rewrite the positions they mask, so as
+ * long as no XNU (which also uppercases) came first, the codes of the
+ * original sequence are reused with just those positions re-encoded.
+ */
+template <typename Tint>
+void FilterPipeline<Tint>::Evaluate(const string& chain, string* out, vector<Interval<Tint>>* all){
+   vector<Step> steps = Parse(chain);
+   string rendered(Seq);
+   vector<Interval<Tint>> masked;
+   string prefix;
+   bool maskonly = true;
+
+   for (size_t k=0; k<steps.size(); k++){
+      Stage st = steps[k].stage;
+      string key = steps[k].chained ? prefix + "+" + Name(st) : string(Name(st));
+      Entry& e = Cache[key];
+
+      if (e.gen != Generation){
+         const unsigned char* enc;
+         if (!steps[k].chained){
+            enc = Encoded(st).data();
+         }else if (maskonly){
+            Work = Encoded(st);
+            for (size_t i=0; i<masked.size(); i++)
+               for (Tint j=masked[i].begin; j<=masked[i].end; j++)
+                  Work[j] = CodeOf(st, rendered[j]);
+            enc = Work.data();
+         }else{
+            EncodeStage(st, rendered, Work);
+            enc = Work.data();
+         }
+         Compute(st, enc, Seq.size(), e.ivs);
+         e.gen = Generation;
+      }
+
+      ApplyStage(st, rendered, e.ivs);
+      masked = UniteIntervals(masked, e.ivs);
+      maskonly = maskonly && st != kXnu;
+      prefix = (k == 0) ? key : prefix + (steps[k].chained ? "+" : "|") + Name(st);
+   }
+
+   if (out != NULL)
+      out->swap(rendered);
+   if (all != NULL)
+      all->swap(masked);
+}
+
+}
+
+#endif
@@ -37,14 +37,23 @@
   * */
  
  
+#ifndef FASTAPLUS_FILTERS_SEG_HPP
+#define FASTAPLUS_FILTERS_SEG_HPP
+
 #include <vector>
 #include <string>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <algorithm>
 #include <math.h>
 #include <unordered_map>
+#include <thread>
+#include <atomic>
 #include <Filters/LnFact.hpp>
+#include <Filters/Interval.hpp>
+#include <Filters/Encode.hpp>
+#include <Utility/Alphabet.hpp>
 #include <Utility/ConvertString.hpp>
 
 
@@ -63,6 +72,11 @@ namespace fastaplus {
  * Modularity above all !!*/
 /**
  * @brief SEG AA sequence filter.
+ *
+ * The filter is not changed by filtering (apart from the pre-screen
+ * counters, which are atomic), so one configured instance can be used by
+ * any number of threads. Per call memory is either local or passed in as
+ * a Scratch owned by the calling thread.
  */
 template <typename Tint>
 class SEG {
@@ -75,25 +89,40 @@ class SEG {
   Tint    MaxTrim; 
   Tint    Period;
   Tint    MergeOverlaps;
+  Tint    Threads;              /* threads used on long sequences */
+  Tint    ChunkSize;            /* minimal tile length for the threaded mode */
+  string  AlphaName;            /* protein | dna */
+  Tint    Prescreen;            /* skip sequences without low complexity windows */
+  Tint    Tables;               /* 0: evaluate log() and ln(n!) directly (reference path) */
+
+/* Counters (the only state changed by filtering) */
+  mutable atomic<unsigned long> Screened;
+  mutable atomic<unsigned long> Skipped;
+
+/* Tables */
+  vector<double> LnFactTab;     /* ln(n!) up to the window/maxtrim bound */
+  vector<double> EntropyTab;    /* c*log2(c/total) for total <= window */
 
 
 /* Structures */
+  static const Tint kMaxAlpha = 20;   /* largest supported alphabet */
+
   struct Alphabet{  
     Tint   alphasize;           /* size */
     double lnalphasize;         /* ln(size) */
-    Tint*  alphaindex;          /* ASCII code table*/ 
-    unsigned char* alphaflag;   /* array of indicators if the characer is (not) AA */
+    const unsigned char* code;  /* residue code per byte, alphasize for X (see Alphabet.hpp) */
+    bool   simdcodes;           /* codes outside 0x40-0x7f are all X */
   } ;
 
   struct CSeq{  
     struct CSeq* parent;        /* current one */
-    char*  seq;                 /* AA sequence */
-    Alphabet* palpha;           /* alphabet info */
+    const unsigned char* seq;   /* residue codes (see Encode) */
+    const Alphabet* palpha;     /* alphabet info */
     Tint   start;               /* starting for seg. */
     Tint   length;              /* sequence length */
     Tint   Xes;                 /* the number of X's */  
-    Tint*  charfreq;            /* number of characters in a string */
-    Tint*  state;                
+    Tint   charfreq[kMaxAlpha]; /* number of characters in a string */
+    Tint   state[kMaxAlpha+1];  /* sorted non-zero charfreq, 0 terminated */
     double entropy;
   } ;
 
@@ -104,46 +133,66 @@ class SEG {
   } ;
   
 
-  Alphabet* alpha;
+  Alphabet alpha;
   
   
 
 /* Functions */
    
-  void     SegFree(SeqSeg* seg);
-  void     MergeSegs(CSeq* seq, SeqSeg* segs);
+  void     SegFree(SeqSeg* seg) const;
+  void     MergeSegs(CSeq* seq, SeqSeg* segs) const;
   template<typename Targ>
   void     SetParamaters(Targ &arg);
-  CSeq*    NewCSeq();
-  double*  ComputeEntropy(CSeq* seq,Tint  first, Tint last, Tint downset, Tint upset);
-  Tint     SegSeq(CSeq* seq, SeqSeg **segs, Tint offset);
-  Tint     LocLow(Tint i, Tint limit, double* H);
-  Tint     LocHigh(Tint i, Tint limit, double* H);
-  CSeq*    OpenWin(CSeq* parent, Tint start, Tint length);
-  void     StateOn(CSeq* win);
-  void     CompOn(CSeq* win);
-  Tint     Trim(CSeq* seq, Tint* leftend, Tint* rightend);
-  void     CloseWin(CSeq* win);
-  bool     ShiftWin1(CSeq* win);
-  double   Entropy(Tint* sv);
-  void     DecrementSV(Tint* sv, Tint clas);
-  void     IncrementSV(Tint* sv, Tint clas);
-  double   GetProb(const Tint* sv, Tint total, const Alphabet* palpha);
-  double   LnPerm(const Tint* sv, Tint window_length);
-  double   LnAss(const Tint* sv, Tint alphasize);
-  double   lnFact(Tint n) ;
-  void     CSeqFree(CSeq* seq);
-  Alphabet* MakeAlpha();
-  void     AlphaFree (Alphabet* alpha);
+  CSeq*    NewCSeq() const;
+  double*  ComputeEntropy(CSeq* seq,Tint  first, Tint last, Tint downset) const;
+  void     EntropyRange(CSeq* seq, double* H, Tint first, Tint last, Tint downset) const;
+  Tint     SegSeq(CSeq* seq, SeqSeg **segs, Tint offset) const;
+  Tint     SegScan(CSeq* seq, double* H, SeqSeg **segs, Tint offset, Tint first, Tint last, Tint upto) const;
+  Tint     SegSeqChunked(CSeq* seq, SeqSeg **segs) const;
+  Tint     LocLow(Tint i, Tint limit, double* H) const;
+  Tint     LocHigh(Tint i, Tint limit, double* H) const;
+  CSeq*    OpenWin(CSeq* parent, Tint start, Tint length) const;
+  void     InitWin(CSeq* win, CSeq* parent, Tint start, Tint length) const;
+  template <int W, int A>
+  void     EntropyKernel(CSeq* seq, double* H, Tint first, Tint last, Tint downset) const;
+  template <int W, int A>
+  double   EntropySV(const Tint* sv, const double* tab) const;
+  void     StateOn(CSeq* win) const;
+  void     CompOn(CSeq* win) const;
+  Tint     Trim(CSeq* seq, Tint* leftend, Tint* rightend) const;
+  void     CloseWin(CSeq* win) const;
+  bool     ShiftWin1(CSeq* win) const;
+  double   Entropy(const Tint* sv) const;
+  void     DecrementSV(Tint* sv, Tint clas) const;
+  void     IncrementSV(Tint* sv, Tint clas) const;
+  double   GetProb(const Tint* sv, Tint total, const Alphabet* palpha, const double* lnf) const;
+  double   LnPerm(const Tint* sv, Tint window_length, const double* lnf) const;
+  double   LnAss(const Tint* sv, Tint alphasize, const double* lnf) const;
+  double   lnFact(Tint n) const ;
+  void     MakeTables();
+  const double* LnFactFor(Tint n, vector<double>& ext) const;
+  void     CSeqFree(CSeq* seq) const;
+  void     MakeAlpha(Alphabet& a);
+  void     MakeAlphaDNA(Alphabet& a);
   template <typename T>
-  void     SafeFree(T *x);
+  void     SafeFree(T *x) const;
   template <typename T>
-  void     SafeFree(T **x);
-  void     EntropyOn(CSeq* win);
+  void     SafeFree(T **x) const;
+  void     EntropyOn(CSeq* win) const;
+  SeqSeg*  Segment(const unsigned char* enc, Tint n) const;
+  bool     MayBeLow(CSeq* seq) const;
   
    
   public:
 
+/**
+ * @brief Working memory of a Mask/FilterInPlace call on a string. Reusing
+ * one Scratch per thread avoids the per call allocation.
+ */
+  struct Scratch{
+    vector<unsigned char> enc;  /* residue codes of the sequence */
+  };
+
 /*!
  * SEG class constructor. 
  * @param arg [unordered_map<string,string>&]
@@ -162,9 +211,98 @@ class SEG {
 
 /*!
  * Filter function identifies and masks (xXx) low complexity segments.
- * @param str [string] // AA sequence
+ * @param str [const string&] // AA sequence
  */
-   string Filter(string str);
+   string Filter(const string& str) const;
+
+/*!
+ * FilterInPlace function masks (xXx) low complexity segments of a given sequence.
+ * @param str [string&] // AA sequence
+ */
+   void FilterInPlace(string& str) const;
+
+/*!
+ * FilterInPlace function overload using the working memory of a given scratch.
+ * @param str [string&] // AA sequence
+ * @param sc [Scratch&]
+ */
+   void FilterInPlace(string& str, Scratch& sc) const;
+
+/*!
+ * Mask function returns the low complexity segments as a list of sorted closed intervals.
+ * Segments are merged unless the merge parameter says otherwise.
+ * @param str [const string&] // AA sequence
+ */
+   vector<Interval<Tint>> Mask(const string& str) const;
+
+/*!
+ * Mask function overload using the working memory of a given scratch.
+ * @param str [const string&] // AA sequence
+ * @param sc [Scratch&]
+ */
+   vector<Interval<Tint>> Mask(const string& str, Scratch& sc) const;
+
+/*!
+ * Mask function overload working on a sequence already translated by Encode.
+ * @param enc [const unsigned char*] // residue codes
+ * @param n [Tint] // sequence length
+ */
+   vector<Interval<Tint>> Mask(const unsigned char* enc, Tint n) const;
+
+/*!
+ * Apply function masks (xXx) the given segments of a sequence in place,
+ * the same way FilterInPlace masks those found by Mask.
+ * @param str [string&] // AA sequence
+ * @param ivs [const vector<Interval<Tint>>&]
+ */
+   void Apply(string& str, const vector<Interval<Tint>>& ivs) const;
+
+/*!
+ * Encode function translates a sequence into the residue codes used by SEG.
+ * @param str [const string&] // AA sequence
+ * @param enc [vector<unsigned char>&] // resized to the sequence length
+ */
+   void Encode(const string& str, vector<unsigned char>& enc) const;
+
+/*!
+ * CodeOf function returns the residue code of a single character.
+ * @param c [char]
+ */
+   unsigned char CodeOf(char c) const;
+
+/*!
+ * Signature function returns the parameters that determine Mask, as a
+ * string (used to key cached results, see MaskCache).
+ */
+   string Signature() const;
+
+/*!
+ * Pre-screen summary getter. \n
+ * Getter retrieves the number of "Screened" and "Skipped" sequences.
+ * @param What [const string&]
+ */
+   unsigned long GetPrescreenSummary(const string& What) const;
+
+/*!
+ * MaskBits function returns low complexity positions as a per position mask.
+ * @param str [const string&] // AA sequence
+ */
+   vector<bool> MaskBits(const string& str) const;
+
+/*!
+ * GetLnFact function returns ln(n!) as used by the trim step (tabulated
+ * up to the window/maxtrim bound, extended past it).
+ * @param n [Tint]
+ */
+   double GetLnFact(Tint n) const;
+
+/*!
+ * GetEntropyTerm function returns the term c*log2(c/total) of the window
+ * entropy (tabulated for total <= window).
+ * @param c [Tint] // count of one residue
+ * @param total [Tint] // residues in the window
+ */
+   double GetEntropyTerm(Tint c, Tint total) const;
 
 };
  
@@ -172,17 +310,25 @@ class SEG {
 
 /* Constructors */
 template <typename Tint>
-SEG<Tint>::SEG(){
+SEG<Tint>::SEG():Screened(0),Skipped(0){
   unordered_map<string,string> para;
   SetParamaters(para);
-  alpha= MakeAlpha();
+  MakeTables();
+  if (AlphaName == "dna")
+     MakeAlphaDNA(alpha);
+  else
+     MakeAlpha(alpha);
 }; 
 
 template <typename Tint>
 template <typename Targ>
-SEG<Tint>::SEG(Targ& arg){
+SEG<Tint>::SEG(Targ& arg):Screened(0),Skipped(0){
   SetParamaters(arg);
-  alpha= MakeAlpha();
+  MakeTables();
+  if (AlphaName == "dna")
+     MakeAlphaDNA(alpha);
+  else
+     MakeAlpha(alpha);
 }
 /* Explicite missing*/
 
@@ -190,66 +336,94 @@ SEG<Tint>::SEG(Targ& arg){
 
 /* Destructors */
 template <typename Tint>
-SEG<Tint>::~SEG(){
-    AlphaFree(alpha);
-}
+SEG<Tint>::~SEG(){}
 /*Explicite missing*/
 
 
 /* Functions  : Public */
 
 template <typename Tint>
-string SEG<Tint>::Filter(string str){
+string SEG<Tint>::Filter(const string& str) const{
+   string filtstr(str);
+   FilterInPlace(filtstr);
+   return filtstr;
+}
 
-  
-  CSeq* seq;
-  SeqSeg* segs;
-  bool params_allocated = false;
-  Tint status = 0;
-  SeqSeg  *seg;
-  Tint begin, end, i;
+template <typename Tint>
+void SEG<Tint>::FilterInPlace(string& str) const{
 
-/* old schoole - parse */
+   Apply(str, Mask(str));
+}
 
-  seq = NewCSeq();
-  seq->seq = &str[0];
-  seq->length = str.size();
-  seq->palpha = alpha;
-  
-  segs = (SeqSeg*) NULL;
+template <typename Tint>
+void SEG<Tint>::FilterInPlace(string& str, Scratch& sc) const{
 
-/* compute lc segments */
-   status = SegSeq (seq, &segs, 0);
-   if (status < 0){
-     seq->seq = NULL;
-     CSeqFree (seq);
-     throw runtime_error ("Low complexity segment computation could not be preformed!" ); 
-   }
-   
-/* Create filtered sequence*/
-    string filtstr(seq->seq);
+   Apply(str, Mask(str, sc));
+}
 
-/* merge segment if specified here you can completly omitt
- * this if raw positions are required by def is set to 1
- * - further testing required - 
- */
-  if (MergeOverlaps == 1){
-      MergeSegs(seq, segs);
-      
-/* Mask: X it*/
-    for (seg=segs; seg!=NULL; seg=seg->next) {
-      begin = seg->begin;
-      end = seg->end;
-      memset(&filtstr[0] + begin, 'X', end - begin +1);
-    }
+template <typename Tint>
+void SEG<Tint>::Apply(string& str, const vector<Interval<Tint>>& ivs) const{
+
+/* raw (unmerged) positions are reported by Mask but never masked */
+   if (MergeOverlaps == 1)
+      ApplyMask(str, ivs, 'X');
 }
 
-/* clean up */
-   seq->seq = NULL;
-   CSeqFree(seq);
+template <typename Tint>
+vector<Interval<Tint>> SEG<Tint>::Mask(const string& str) const{
+   Scratch sc;
+   return Mask(str, sc);
+}
+
+template <typename Tint>
+vector<Interval<Tint>> SEG<Tint>::Mask(const string& str, Scratch& sc) const{
+   Encode(str, sc.enc);
+   return Mask(sc.enc.data(), str.size());
+}
+
+template <typename Tint>
+vector<Interval<Tint>> SEG<Tint>::Mask(const unsigned char* enc, Tint n) const{
+   vector<Interval<Tint>> ivs;
+   SeqSeg* segs = Segment(enc, n);
+
+   for (SeqSeg* seg=segs; seg!=NULL; seg=seg->next){
+      Interval<Tint> iv = {seg->begin, seg->end};
+      ivs.push_back(iv);
+   }
+   sort(ivs.begin(), ivs.end(), [](const Interval<Tint>& a, const Interval<Tint>& b){
+      return a.begin < b.begin || (a.begin == b.begin && a.end < b.end);
+   });
+
    SegFree(segs);
-   
-   return filtstr;	
+   return ivs;
+}
+
+template <typename Tint>
+unsigned long SEG<Tint>::GetPrescreenSummary(const string& What) const{
+   if (What.compare("Screened") == 0)
+      return Screened;
+   else if (What.compare("Skipped") == 0)
+      return Skipped;
+   return 0;
+}
+
+template <typename Tint>
+vector<bool> SEG<Tint>::MaskBits(const string& str) const{
+   return IntervalsToBits(Mask(str), str.size());
+}
+
+template <typename Tint>
+double SEG<Tint>::GetLnFact(Tint n) const{
+   vector<double> ext;
+   return LnFactFor(n, ext)[n];
+}
+
+template <typename Tint>
+double SEG<Tint>::GetEntropyTerm(Tint c, Tint total) const{
+   if (total <= SegWindow && !EntropyTab.empty())
+      return EntropyTab[total*(SegWindow+1)+c];
+   const double ln2 = 0.69314718055994530941723212145818;
+   return ((double)c)*log(((double)c)/(double)total)/ln2;
 }
 
 
@@ -267,6 +441,11 @@ void SEG<Tint>::SetParamaters(Targ &arg){
   MaxTrim = (arg.find("maxtrim")    == arg.end() || StringToNumeric<Tint>(arg["maxtrim"])    < 0)  ?  100 : StringToNumeric<Tint>(arg["maxtrim"]);
   Period = (arg.find("period")      == arg.end() || StringToNumeric<Tint>(arg["period"])     < 1)  ?  1   : StringToNumeric<Tint>(arg["period"]);
   MergeOverlaps = (arg.find("merge")== arg.end() || StringToNumeric<Tint>(arg["merge"])      < 1)  ?  1   : StringToNumeric<Tint>(arg["merge"]);
+  Threads = (arg.find("threads")    == arg.end() || StringToNumeric<Tint>(arg["threads"])    < 1)  ?  1   : StringToNumeric<Tint>(arg["threads"]);
+  ChunkSize = (arg.find("chunk")    == arg.end() || StringToNumeric<Tint>(arg["chunk"])      < 1)  ?  100000 : StringToNumeric<Tint>(arg["chunk"]);
+  AlphaName = (arg.find("alphabet") == arg.end() || arg["alphabet"].compare("dna") != 0)    ?  "protein" : "dna";
+  Prescreen = (arg.find("prescreen")== arg.end() || StringToNumeric<Tint>(arg["prescreen"])  < 1)  ?  0   : 1;
+  Tables = (arg.find("tables")      == arg.end() || StringToNumeric<Tint>(arg["tables"])     >= 1) ?  1   : 0;
   
   
    if ( SegLocut > SegHicut)
@@ -274,10 +453,110 @@ void SEG<Tint>::SetParamaters(Targ &arg){
 
    if (MaxX > SegWindow)
        MaxX = SegWindow;
+
+   if (ChunkSize < SegWindow + MaxTrim)
+       ChunkSize = SegWindow + MaxTrim;
+}
+
+template <typename Tint>
+typename SEG<Tint>::SeqSeg* SEG<Tint>::Segment(const unsigned char* enc, Tint n) const{
+
+  CSeq* seq;
+  SeqSeg* segs;
+  Tint status = 0;
+
+/* old schoole - parse */
+
+  seq = NewCSeq();
+  seq->seq = enc;
+  seq->length = n;
+  seq->palpha = &alpha;
+
+  segs = (SeqSeg*) NULL;
+
+  if (Prescreen){
+     Screened++;
+     if (!MayBeLow(seq)){
+        Skipped++;
+        CSeqFree(seq);
+        return segs;
+     }
+  }
+
+/* compute lc segments */
+   if (Threads > 1 && seq->length >= 2*ChunkSize)
+      status = SegSeqChunked(seq, &segs);
+   else
+      status = SegSeq (seq, &segs, 0);
+   if (status < 0){
+     CSeqFree (seq);
+     SegFree(segs);
+     throw runtime_error ("Low complexity segment computation could not be preformed!" );
+   }
+
+/* merge segment if specified here you can completly omitt
+ * this if raw positions are required by def is set to 1
+ * - further testing required -
+ */
+   if (MergeOverlaps == 1)
+      MergeSegs(seq, segs);
+
+/* clean up: the sequence itself is only viewed */
+   CSeqFree(seq);
+
+   return segs;
 }
 
+/* Composition pre-screen.
+ *
+ * Shannon entropy is bounded from below by the collision entropy
+ * -log2(S/t^2), where S is the sum of squared residue counts and t the
+ * number of residues in a window. A window can only reach locut if
+ * S >= t^2 * 2^-locut, so a sequence where no window passes this test
+ * cannot produce any segment and SegSeq is skipped. S is updated in O(1)
+ * per shift.
+ */
 template <typename Tint>
-void SEG<Tint>::SegFree(SeqSeg* seg){
+bool SEG<Tint>::MayBeLow(CSeq* seq) const{
+   Tint comp[kMaxAlpha];
+   Tint i, j, sq = 0, xes = 0;
+   Tint W = SegWindow;
+   Tint A = seq->palpha->alphasize;
+   const unsigned char* p = seq->seq;
+   const double thr = pow(2.0, -SegLocut) * (1.0 - 1e-9);
+
+   if (W > seq->length)
+      return false;
+
+   for (j=0; j<seq->palpha->alphasize; j++)
+      comp[j] = 0;
+
+   for (i=0; i<seq->length; i++){
+      Tint c = p[i];
+      if (c < A)
+         sq += 2*comp[c]++ + 1;
+      else
+         xes++;
+
+      if (i >= W){
+         c = p[i-W];
+         if (c < A)
+            sq -= 2*comp[c]-- - 1;
+         else
+            xes--;
+      }
+
+      if (i >= W-1 && xes <= MaxX){
+         double t = W - xes;
+         if (t == 0 || sq >= t*t*thr)
+            return true;
+      }
+   }
+   return false;
+}
+
+template <typename Tint>
+void SEG<Tint>::SegFree(SeqSeg* seg) const{
    SeqSeg* nextseg;
    while (seg){
       nextseg = seg->next;
@@ -287,7 +566,7 @@ void SEG<Tint>::SegFree(SeqSeg* seg){
 }
 
 template <typename Tint>
- void SEG<Tint>::MergeSegs(CSeq* seq, SeqSeg* segs){
+ void SEG<Tint>::MergeSegs(CSeq* seq, SeqSeg* segs) const{
 	 
    SeqSeg* seg,* nextseg;          
 
@@ -314,7 +593,7 @@ template <typename Tint>
 }
 
 template <typename Tint>
-typename SEG<Tint>::CSeq*  SEG<Tint>::NewCSeq(){
+typename SEG<Tint>::CSeq*  SEG<Tint>::NewCSeq() const{
    CSeq* seq;
 
    seq = (CSeq*) calloc(1, sizeof(CSeq));
@@ -322,21 +601,19 @@ typename SEG<Tint>::CSeq*  SEG<Tint>::NewCSeq(){
       return(seq);
 
    seq->parent = (CSeq*) NULL;
-   seq->seq = (char*) NULL;
-   seq->palpha = (Alphabet*) NULL;
+   seq->seq = (const unsigned char*) NULL;
+   seq->palpha = (const Alphabet*) NULL;
    seq->start = 0;
    seq->length = 0;
    seq->Xes =false;
-   seq->charfreq = seq->state = (Tint*) NULL;
    seq->entropy = (double) 0.0;
 
    return(seq);
 }
 
 template <typename Tint>
-double* SEG<Tint>::ComputeEntropy(CSeq* seq,Tint  first, Tint last, Tint downset, Tint upset){
+double* SEG<Tint>::ComputeEntropy(CSeq* seq,Tint  first, Tint last, Tint downset) const{
 	
-   CSeq* win;
    double* H;
    Tint i;
 
@@ -349,7 +626,29 @@ double* SEG<Tint>::ComputeEntropy(CSeq* seq,Tint  first, Tint last, Tint downset
    for (i=0; i<seq->length; i++)
       H[i] = -1.0;
 
-   win = OpenWin(seq, 0, SegWindow);
+   EntropyRange(seq, H, first, last, downset);
+   return(H);
+}
+
+template <typename Tint>
+void SEG<Tint>::EntropyRange(CSeq* seq, double* H, Tint first, Tint last, Tint downset) const{
+   CSeq* win;
+   Tint i;
+
+/* fixed size kernels for the standard settings */
+   if (!EntropyTab.empty()){
+      Tint A = seq->palpha->alphasize;
+      if (A == 20 && SegWindow == 12)
+         return EntropyKernel<12,20>(seq, H, first, last, downset);
+      if (A == 20 && SegWindow == 45)
+         return EntropyKernel<45,20>(seq, H, first, last, downset);
+      if (A == 4 && SegWindow == 12)
+         return EntropyKernel<12,4>(seq, H, first, last, downset);
+      if (A == 4 && SegWindow == 45)
+         return EntropyKernel<45,4>(seq, H, first, last, downset);
+   }
+
+   win = OpenWin(seq, first-downset, SegWindow);
    EntropyOn(win);
 
    for (i=first; i<=last; i++){
@@ -363,17 +662,78 @@ double* SEG<Tint>::ComputeEntropy(CSeq* seq,Tint  first, Tint last, Tint downset
      }
 
    CloseWin(win);
-   return(H);
 }
 
+/* Same scan as the generic path of EntropyRange with the window length
+ * and the alphabet size known at compile time: composition and state
+ * vectors live on the stack and all loops over them have fixed bounds.
+ */
 template <typename Tint>
-Tint SEG<Tint>::SegSeq(CSeq* seq, SeqSeg **segs, Tint offset){
-   SeqSeg* seg = (SeqSeg*) NULL;
+template <int W, int A>
+void SEG<Tint>::EntropyKernel(CSeq* seq, double* H, Tint first, Tint last, Tint downset) const{
+   Tint comp[A];
+   Tint sv[A+1];
+   Tint i, j, nel, xes = 0;
+   const double* tab = EntropyTab.data();
+   const unsigned char* p = seq->seq + first - downset;
+
+   for (j=0; j<A; j++)
+      comp[j] = 0;
+   for (j=0; j<W; j++){
+      Tint c = p[j];
+      if (c < A)
+         comp[c]++;
+      else
+         xes++;
+   }
+   for (j = nel = 0; j<A; j++)
+      if (comp[j] != 0)
+         sv[nel++] = comp[j];
+   for (j=nel; j<A+1; j++)
+      sv[j] = 0;
+   sort(sv, sv+nel, greater<Tint>());
+
+   for (i=first; ; i++){
+      H[i] = (xes > MaxX) ? -1. : EntropySV<W,A>(sv, tab);
+      if (i>=last)
+         break;
+
+      if ((j = p[0]) < A)
+         DecrementSV(sv, comp[j]--);
+      else
+         xes--;
+      j = p[W];
+      ++p;
+      if (j < A)
+         IncrementSV(sv, comp[j]++);
+      else
+         xes++;
+   }
+}
+
+template <typename Tint>
+template <int W, int A>
+double SEG<Tint>::EntropySV(const Tint* sv, const double* tab) const{
+   double ent = 0.0;
+   Tint i, total = 0;
+
+   for (i=0; i<A && sv[i]!=0; i++)
+      total += sv[i];
+   if (total==0) return(0.);
+
+   const double* row = tab + total*(W+1);
+   for (i=0; i<A && sv[i]!=0; i++)
+      ent += row[sv[i]];
+   double f = ent/(double)total;
+
+   return (f < 0.0) ? -(f) : (f);
+}
+
+template <typename Tint>
+Tint SEG<Tint>::SegSeq(CSeq* seq, SeqSeg **segs, Tint offset) const{
 
    Tint downset, upset;
-   Tint first, last, lowlim;
-   Tint i;
-   Tint leftend, rightend;
+   Tint first, last;
    double* H;
    Tint status = 0;
 
@@ -381,13 +741,35 @@ Tint SEG<Tint>::SegSeq(CSeq* seq, SeqSeg **segs, Tint offset){
    upset = SegWindow - downset;
    first = downset;
    last = seq->length - upset;
-   lowlim = first;
    
-   H = ComputeEntropy(seq,  first,  last,  downset,  upset);
+   H = ComputeEntropy(seq,  first,  last,  downset);
 
    if (H == NULL) 
       return status;
-   for (i=first; i<=last; i++){
+
+   status = SegScan(seq, H, segs, offset, first, last, last);
+   if (status < 0)
+      return status;
+
+   SafeFree(H);
+   return status;
+}
+
+template <typename Tint>
+Tint SEG<Tint>::SegScan(CSeq* seq, double* H, SeqSeg **segs, Tint offset, Tint first, Tint last, Tint upto) const{
+   SeqSeg* seg = (SeqSeg*) NULL;
+
+   Tint downset, upset;
+   Tint lowlim;
+   Tint i;
+   Tint leftend, rightend;
+   Tint status = 0;
+
+   downset = (SegWindow+1)/2 - 1;
+   upset = SegWindow - downset;
+   lowlim = first;
+
+   for (i=first; i<=upto; i++){
       if (H[i] <= SegLocut && H[i] != -1.0){
          Tint loi = LocLow(i, lowlim, H); 
          Tint hii = LocHigh(i, last, H);
@@ -430,12 +812,107 @@ Tint SEG<Tint>::SegSeq(CSeq* seq, SeqSeg **segs, Tint offset){
          lowlim = i + 1;
         }
    }
+   return status;
+}
+
+/* Threaded variant of SegSeq for long sequences.
+ *
+ * Window entropies are independent, so they are computed per tile. The
+ * segment scan is then cut at breakpoints, i.e. positions whose entropy
+ * is above hicut (or undefined). LocLow/LocHigh never extend a region
+ * across such a position and no segment is triggered on it, so the scan
+ * on either side of a breakpoint does not depend on the other side and
+ * the concatenated segment list is identical to the serial one.
+ * A tile without a breakpoint is simply joined with the next one.
+ */
+template <typename Tint>
+Tint SEG<Tint>::SegSeqChunked(CSeq* seq, SeqSeg **segs) const{
+
+   Tint downset, upset;
+   Tint first, last;
+   Tint i;
+   double* H;
+   Tint status = 0;
+
+   downset = (SegWindow+1)/2 - 1;
+   upset = SegWindow - downset;
+   first = downset;
+   last = seq->length - upset;
+
+   if (SegWindow>seq->length)
+      return status;
+
+   H = (double*) calloc(seq->length, sizeof(double));
+   for (i=0; i<seq->length; i++)
+      H[i] = -1.0;
+
+   Tint nthreads = Threads;
+   atomic<Tint> next(0);
+
+/* entropy per tile, tiles overlap by the window length on the sequence */
+   vector<pair<Tint,Tint>> tiles;
+   for (i=first; i<=last; i+=ChunkSize)
+      tiles.push_back(make_pair(i, min(i+ChunkSize-1, last)));
+
+   auto entropy = [&](){
+      for (Tint t = next++; t < (Tint) tiles.size(); t = next++)
+         EntropyRange(seq, H, tiles[t].first, tiles[t].second, downset);
+   };
+
+   vector<thread> pool;
+   for (Tint t=0; t<nthreads; t++)
+      pool.push_back(thread(entropy));
+   for (Tint t=0; t<nthreads; t++)
+      pool[t].join();
+
+/* cut the scan at the first breakpoint past each tile boundary */
+   vector<pair<Tint,Tint>> chunks;
+   Tint from = first;
+   for (size_t t=1; t<tiles.size(); t++){
+      Tint b = max(tiles[t].first, from);
+      while (b<=last && H[b]!=-1.0 && H[b]<=SegHicut)
+         b++;
+      if (b>=last)
+         break;
+      chunks.push_back(make_pair(from, b));
+      from = b+1;
+   }
+   chunks.push_back(make_pair(from, last));
+
+   vector<SeqSeg*> parts(chunks.size(), (SeqSeg*) NULL);
+   vector<Tint> states(chunks.size(), 0);
+   next = 0;
+
+   auto scan = [&](){
+      for (Tint c = next++; c < (Tint) chunks.size(); c = next++)
+         states[c] = SegScan(seq, H, &parts[c], 0, chunks[c].first, last, chunks[c].second);
+   };
+
+   pool.clear();
+   for (Tint t=0; t<nthreads; t++)
+      pool.push_back(thread(scan));
+   for (Tint t=0; t<nthreads; t++)
+      pool[t].join();
+
+/* serial order: segments of later chunks come first in the list */
+   for (size_t c=0; c<chunks.size(); c++){
+      if (states[c] < 0)
+         status = states[c];
+      if (parts[c] == NULL)
+         continue;
+      SeqSeg* tail = parts[c];
+      while (tail->next != NULL)
+         tail = tail->next;
+      tail->next = *segs;
+      *segs = parts[c];
+   }
+
    SafeFree(H);
    return status;
 }
 
 template <typename Tint>
-Tint SEG<Tint>::LocLow(Tint i, Tint limit, double* H){
+Tint SEG<Tint>::LocLow(Tint i, Tint limit, double* H) const{
    Tint j;
    for (j=i; j>=limit; j--){
       if (H[j]==-1.0) break;
@@ -445,7 +922,7 @@ Tint SEG<Tint>::LocLow(Tint i, Tint limit, double* H){
 }
 
 template <typename Tint>
-Tint SEG<Tint>::LocHigh(Tint i, Tint limit, double* H){
+Tint SEG<Tint>::LocHigh(Tint i, Tint limit, double* H) const{
    Tint j;
    for (j=i; j<=limit; j++){
       if (H[j]==-1.0) break;
@@ -455,13 +932,20 @@ Tint SEG<Tint>::LocHigh(Tint i, Tint limit, double* H){
 }
 
 template <typename Tint>
-typename SEG<Tint>::CSeq* SEG<Tint>::OpenWin(CSeq* parent, Tint start, Tint length){
+typename SEG<Tint>::CSeq* SEG<Tint>::OpenWin(CSeq* parent, Tint start, Tint length) const{
    CSeq* win;
 
    if (start<0 || length<0 || start+length>parent->length)
       return((CSeq*) NULL);
 
     win = (CSeq*) calloc(1, sizeof(CSeq));
+    InitWin(win, parent, start, length);
+
+    return win;
+}
+
+template <typename Tint>
+void SEG<Tint>::InitWin(CSeq* win, CSeq* parent, Tint start, Tint length) const{
     win->parent = parent;
     win->palpha = parent->palpha;
     win->start = start;
@@ -469,22 +953,16 @@ typename SEG<Tint>::CSeq* SEG<Tint>::OpenWin(CSeq* parent, Tint start, Tint leng
     win->seq = parent->seq + start;
     win->Xes = 0;
     win->entropy = -2.;
-    win->state = (Tint*) NULL;
-    win->charfreq = (Tint*) NULL;
 	
     StateOn(win);
-
-    return win;
 }
 
 template <typename Tint>
-void SEG<Tint>::StateOn(CSeq* win){
+void SEG<Tint>::StateOn(CSeq* win) const{
 	Tint letter, nel, c;
     Tint alphasize =  win->palpha->alphasize;
 
-	if (win->charfreq == NULL)
-		CompOn(win);
-	win->state = (Tint*) calloc((alphasize+1), sizeof(win->state[0]));
+	CompOn(win);
 	for (letter = nel = 0; letter < alphasize; ++letter) {
 		if ((c = win->charfreq[letter]) == 0)
 			continue;
@@ -497,34 +975,42 @@ void SEG<Tint>::StateOn(CSeq* win){
 }
 
 template <typename Tint>
-void SEG<Tint>::CompOn(CSeq* win){
+void SEG<Tint>::CompOn(CSeq* win) const{
   Tint* comp;
-  Tint letter;
-  char* seq = win->seq; 
-  char* seqmax = seq + win->length;
-  Tint* alphaindex = win->palpha->alphaindex;
-  unsigned char* alphaflag = win->palpha->alphaflag;
+  Tint letter, k;
+  const unsigned char* seq = win->seq;
+  Tint length = win->length;
   Tint alphasize = win->palpha->alphasize;
-
-  win->charfreq = comp = (Tint*) calloc(alphasize, sizeof(Tint));
-
-  while (seq < seqmax) {
-    letter = *seq++;
-    if (!alphaflag[letter])
-      comp[alphaindex[letter]]++;
-    else 
-      win->Xes++;
+  Tint cnt[4][kMaxAlpha+1];
+
+/* four interleaved histograms, so consecutive equal residues do not
+ * wait on each other's increments; X has its own bin at alphasize */
+  memset(cnt, 0, sizeof(cnt));
+  for (k = 0; k+4 <= length; k += 4){
+    cnt[0][seq[k]]++;
+    cnt[1][seq[k+1]]++;
+    cnt[2][seq[k+2]]++;
+    cnt[3][seq[k+3]]++;
   }
+  for (; k < length; k++)
+    cnt[0][seq[k]]++;
+
+  comp = win->charfreq;
+  for (letter = 0; letter < alphasize; letter++)
+    comp[letter] = cnt[0][letter] + cnt[1][letter] + cnt[2][letter] + cnt[3][letter];
+  win->Xes += cnt[0][alphasize] + cnt[1][alphasize] + cnt[2][alphasize] + cnt[3][alphasize];
 }
 
 template <typename Tint>
-Tint SEG<Tint>::Trim(CSeq* seq, Tint* leftend, Tint* rightend){
+Tint SEG<Tint>::Trim(CSeq* seq, Tint* leftend, Tint* rightend) const{
    double prob, minprob = 1;
    Tint len;
    Tint lend=0 ;
    Tint rend =seq->length - 1;
    Tint minlen = 1;
    Tint status = 0;
+   vector<double> ext;
+   const double* lnf = LnFactFor(seq->length, ext);
 
    if ((seq->length-MaxTrim)>minlen) 
         minlen = seq->length-MaxTrim;
@@ -532,20 +1018,20 @@ Tint SEG<Tint>::Trim(CSeq* seq, Tint* leftend, Tint* rightend){
    for (len=seq->length; len>minlen; len--){
       bool shift = true;
       Tint i = 0;
-      CSeq* win = OpenWin(seq, 0, len);
+      CSeq win;
+      InitWin(&win, seq, 0, len);
 
       while (shift){
-         prob = GetProb(win->state, len, win->palpha);
+         prob = GetProb(win.state, len, win.palpha, lnf);
          if (prob<minprob)
          {
             minprob = prob;
             lend = i;
             rend = len + i - 1;
          }
-         shift = ShiftWin1(win);
+         shift = ShiftWin1(&win);
          i++;
       }
-      CloseWin(win);
    }
 
    *leftend = *leftend + lend;
@@ -556,39 +1042,35 @@ Tint SEG<Tint>::Trim(CSeq* seq, Tint* leftend, Tint* rightend){
 }
 
 template <typename Tint>
-void SEG<Tint>::CloseWin(CSeq* win)
+void SEG<Tint>::CloseWin(CSeq* win) const
 {
    if (win==NULL) return;
 
-   if (win->state!=NULL)       SafeFree(win->state);
-   if (win->charfreq!=NULL) SafeFree(win->charfreq);
-
    SafeFree(win);
    return;
 }
 
 template <typename Tint>
-bool SEG<Tint>::ShiftWin1(CSeq* win){
+bool SEG<Tint>::ShiftWin1(CSeq* win) const{
 	
   Tint j, length = win->length;
   Tint* comp = win->charfreq;
-  Tint* alphaindex = win->palpha->alphaindex;
-  unsigned char* alphaflag = win->palpha->alphaflag;
+  Tint A = win->palpha->alphasize;
 
   if ((++win->start + length) > win->parent->length) {
     --win->start;
     return false;
   }
 
-  if (!alphaflag[j = win->seq[0]])
-    DecrementSV(win->state, comp[alphaindex[j]]--);
+  if ((j = win->seq[0]) < A)
+    DecrementSV(win->state, comp[j]--);
   else 
     win->Xes--;
   j = win->seq[length];
   ++win->seq;
 
-  if (!alphaflag[j])
-    IncrementSV(win->state, comp[alphaindex[j]]++);
+  if (j < A)
+    IncrementSV(win->state, comp[j]++);
   else 
     win->Xes++;
 
@@ -599,7 +1081,7 @@ bool SEG<Tint>::ShiftWin1(CSeq* win){
 }
 
 template <typename Tint>
-double SEG<Tint>::Entropy(Tint* sv){
+double SEG<Tint>::Entropy(const Tint* sv) const{
    double ent;
    Tint i, total = 0;
 
@@ -610,9 +1092,15 @@ double SEG<Tint>::Entropy(Tint* sv){
    if (total==0) return(0.);
 
    ent = 0.0;
-   const double ln2 = 0.69314718055994530941723212145818;
-   for (i=0; sv[i]!=0; i++)
-      ent += ((double)sv[i])*log(((double)sv[i])/(double)total)/ln2;   /// WHAT IS THIS
+   if (total < SegWindow+1 && !EntropyTab.empty()){
+      const double* row = &EntropyTab[total*(SegWindow+1)];
+      for (i=0; sv[i]!=0; i++)
+         ent += row[sv[i]];
+   }else{
+      const double ln2 = 0.69314718055994530941723212145818;
+      for (i=0; sv[i]!=0; i++)
+         ent += ((double)sv[i])*log(((double)sv[i])/(double)total)/ln2;   /// WHAT IS THIS
+   }
    double f = ent/(double)total; 
    ent = (f < 0.0) ? -(f) : (f);
 
@@ -620,7 +1108,7 @@ double SEG<Tint>::Entropy(Tint* sv){
 }
 
 template <typename Tint>
-void SEG<Tint>::DecrementSV(Tint* sv, Tint clas){
+void SEG<Tint>::DecrementSV(Tint* sv, Tint clas) const{
   Tint	svi;
   while ((svi = *sv++) != 0) {
     if (svi == clas && *sv < clas) {
@@ -631,7 +1119,7 @@ void SEG<Tint>::DecrementSV(Tint* sv, Tint clas){
 }
 
 template <typename Tint>
-void SEG<Tint>::IncrementSV(Tint* sv, Tint clas){
+void SEG<Tint>::IncrementSV(Tint* sv, Tint clas) const{
   for (;;) {
     if (*sv++ == clas) {
       sv[-1]++;
@@ -641,40 +1129,38 @@ void SEG<Tint>::IncrementSV(Tint* sv, Tint clas){
 }
 
 template <typename Tint>
-double SEG<Tint>::GetProb(const Tint* sv, Tint total, const Alphabet* palpha){
+double SEG<Tint>::GetProb(const Tint* sv, Tint total, const Alphabet* palpha, const double* lnf) const{
    double  ans1, ans2 = 0, totseq;
 
    totseq = ((double) total) * (palpha->lnalphasize);
 
-   ans1 = LnAss(sv, palpha->alphasize);
+   ans1 = LnAss(sv, palpha->alphasize, lnf);
    if (ans1 > -100000.0 && sv[0] != (-2147483647-1))  // ncbi constant
-      ans2 = LnPerm(sv, total);
-   else
-      cerr <<"Bad value!\n";
+      ans2 = LnPerm(sv, total, lnf);
    
    return  ans1 + ans2 - totseq;
 }
   
 template <typename Tint>
-double SEG<Tint>::LnPerm(const Tint* sv, Tint window_length){
+double SEG<Tint>::LnPerm(const Tint* sv, Tint window_length, const double* lnf) const{
    double ans;
    Tint i;
    
-   ans = lnFact(window_length);
+   ans = lnf[window_length];
    for (i=0; sv[i]!=0; i++)
-      ans -= lnFact(sv[i]);
+      ans -= lnf[sv[i]];
 
    return(ans);
 }
 
 template <typename Tint>
-double SEG<Tint>::LnAss(const Tint* sv, Tint alphasize){
+double SEG<Tint>::LnAss(const Tint* sv, Tint alphasize, const double* lnf) const{
   double	ans;
   Tint	svi, svim1;
   Tint	clas, total;
   Tint    i;
 
-  ans = lnFactA[alphasize];
+  ans = lnf[alphasize];
   if (sv[0] == 0)
     return ans;
 
@@ -684,16 +1170,16 @@ double SEG<Tint>::LnAss(const Tint* sv, Tint alphasize){
   svim1 = sv[0];
   for (i=0;; svim1 = svi) {
     if (++i==alphasize) {
-      ans -= lnFact(clas);
+      ans -= lnf[clas];
       break;
     }else if ((svi = *++sv) == svim1) {
       clas++;
       continue;
     }else {
       total -= clas;
-      ans -= lnFact(clas);
+      ans -= lnf[clas];
       if (svi == 0) {
-        ans -= lnFact(total);
+        ans -= lnf[total];
         break;
       }else {
         clas = 1;
@@ -705,82 +1191,121 @@ double SEG<Tint>::LnAss(const Tint* sv, Tint alphasize){
 }
  
 template <typename Tint>
-double SEG<Tint>::lnFact(Tint n) {
-  if (n < sizeof(lnFactA)/sizeof(*lnFactA))
+double SEG<Tint>::lnFact(Tint n) const {
+  if (n >= 0 && (size_t) n < sizeof(lnFactA)/sizeof(*lnFactA))
      return lnFactA[n];
   else 
     return ((n+0.5)*log(n) - n + 0.9189385332);
 }
 
+/* All log-factorials and window entropy terms are tabulated once per
+ * parameter set so that the trim loop and the entropy scan do not call
+ * log(). Table entries are evaluated with exactly the same expressions
+ * as the direct code, hence results are bit identical. With tables=0
+ * nothing is tabulated and the direct code is run (the reference the
+ * tests compare against).
+ */
+template <typename Tint>
+void SEG<Tint>::MakeTables(){
+   Tint n, c;
+   Tint bound = sizeof(lnFactA)/sizeof(*lnFactA);
+
+   if (SegWindow + MaxTrim + 1 > bound)
+      bound = SegWindow + MaxTrim + 1;
+
+   LnFactTab.clear();
+   EntropyTab.clear();
+   if (!Tables)
+      return;
+
+   LnFactTab.resize(bound);
+   for (n=0; n<bound; n++)
+      LnFactTab[n] = lnFact(n);
+
+   if (SegWindow > 256)
+      return;
+
+   const double ln2 = 0.69314718055994530941723212145818;
+   EntropyTab.assign((SegWindow+1)*(SegWindow+1), 0.0);
+   for (n=1; n<=SegWindow; n++)
+      for (c=1; c<=n; c++)
+         EntropyTab[n*(SegWindow+1)+c] = ((double)c)*log(((double)c)/(double)n)/ln2;
+}
+
+/* Segments longer than the cached bound get a private extension of the
+ * table for the duration of a single Trim call. */
+template <typename Tint>
+const double* SEG<Tint>::LnFactFor(Tint n, vector<double>& ext) const{
+   Tint k;
+
+   if (n < (Tint) LnFactTab.size())
+      return LnFactTab.data();
+
+/* LnAss reads up to ln(alphasize!) whatever the segment length */
+   if (n < kMaxAlpha)
+      n = kMaxAlpha;
+
+   ext.resize(n+1);
+   copy(LnFactTab.begin(), LnFactTab.end(), ext.begin());
+   for (k=LnFactTab.size(); k<=n; k++)
+      ext[k] = lnFact(k);
+   return ext.data();
+}
+
 template <typename Tint>
-void SEG<Tint>::CSeqFree(CSeq* seq){
+void SEG<Tint>::CSeqFree(CSeq* seq) const{
    if (seq==NULL) return;
-   SafeFree(seq->seq);
-   SafeFree(seq->charfreq);
-   SafeFree(seq->state);
    SafeFree(seq);
 }
 
+/* Upper case only: SEG has always read lower case residues as X, so the
+ * protein table does not fold case (the DNA one does).
+ */
 template <typename Tint>
-typename SEG<Tint>::Alphabet* SEG<Tint>::MakeAlpha (){
-   Alphabet* palpha;
-   Tint* alphaindex;
-   unsigned char* alphaflag;
-   Tint c,  i;
-   const int kCharSet = 128;
+void SEG<Tint>::MakeAlpha (Alphabet& a){
    const double kLn20 = 2.9957322735539909;  // ncbi 
 
-   palpha = (Alphabet*) calloc(1, sizeof(Alphabet));
-
-   palpha->alphasize = 20;
-   palpha->lnalphasize = kLn20;
-
-   alphaindex = (Tint*) calloc(kCharSet , sizeof(Tint));
-   alphaflag = (unsigned char*) calloc(kCharSet , sizeof(char));
+   a.alphasize = Protein20::Size;
+   a.lnalphasize = kLn20;
+   a.code = AlphabetLut<Protein20, false>::code;
+   a.simdcodes = LutIsLetterOnly(a.code, (unsigned char) a.alphasize);
+}
 
-   for (c=0, i=0; c<kCharSet; c++)
-     {
-        if (c == 65 || 
-           (c >= 67 && c <= 73) || 
-           (c >= 75 && c <= 78) || 
-           (c >= 80 && c <= 84) || 
-           (c >= 86 && c <= 87) ||  
-           c == 89) {
-			   
-           alphaflag[c] = false; 
-           alphaflag[c+32] = false;
-           alphaindex[c] = i; 
-           alphaindex[c+32] = i;
-           ++i;
-        } else {
-           alphaflag[c] = true; 
-           alphaindex[c] = 20;
-        }
-     }
+template <typename Tint>
+void SEG<Tint>::MakeAlphaDNA (Alphabet& a){
+   a.alphasize = DNA4::Size;
+   a.lnalphasize = 1.3862943611198906;  // ln(4)
+   a.code = AlphabetLut<DNA4>::code;
+   a.simdcodes = LutIsLetterOnly(a.code, (unsigned char) a.alphasize);
+}
 
-   palpha->alphaindex = alphaindex;
-   palpha->alphaflag = alphaflag;
+template <typename Tint>
+void SEG<Tint>::Encode(const string& str, vector<unsigned char>& enc) const{
+   enc.resize(str.size());
+   EncodeBytes(alpha.code, alpha.simdcodes, (unsigned char) alpha.alphasize,
+               (const unsigned char*) str.data(), enc.data(), str.size());
+}
 
-   return (palpha);
+template <typename Tint>
+unsigned char SEG<Tint>::CodeOf(char c) const{
+   return alpha.code[(unsigned char) c];
 }
 
 template <typename Tint>
-void SEG<Tint>::AlphaFree (Alphabet* alpha){
-   SafeFree (alpha->alphaindex);
-   SafeFree (alpha->alphaflag);
-   SafeFree (alpha);
+string SEG<Tint>::Signature() const{
+   return "SEG/" + AlphaName + "/" + NumericToString(SegWindow) + "/" + NumericToString(SegLocut)
+        + "/" + NumericToString(SegHicut) + "/" + NumericToString(MaxX) + "/" + NumericToString(MaxTrim)
+        + "/" + NumericToString(MergeOverlaps);
 }
 
 template <typename Tint>
-void  SEG<Tint>::EntropyOn(CSeq* win){
-   if (win->state==NULL) 
-     StateOn(win);
+void  SEG<Tint>::EntropyOn(CSeq* win) const{
    win->entropy = Entropy(win->state);
 }
 
 template <typename Tint>
 template <typename T>
-void SEG<Tint>::SafeFree(T **x){
+void SEG<Tint>::SafeFree(T **x) const{
     free(*x);
     *x = NULL;
 
@@ -788,7 +1313,7 @@ void SEG<Tint>::SafeFree(T **x){
 
 template <typename Tint>
 template <typename T>
-void SEG<Tint>::SafeFree(T *x){
+void SEG<Tint>::SafeFree(T *x) const{
     free(x);
     x = NULL;
 
@@ -796,3 +1321,5 @@ void SEG<Tint>::SafeFree(T *x){
 
 
 } // end fasta
+
+#endif
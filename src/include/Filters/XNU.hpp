@@ -36,28 +36,137 @@
 
 
 
+#ifndef FASTAPLUS_FILTERS_XNU_HPP
+#define FASTAPLUS_FILTERS_XNU_HPP
+
 #include <cctype>
 #include <cmath>
 
 
 #include <Filters/XNUData.hpp>
+#include <Filters/Interval.hpp>
+#include <Utility/ConvertString.hpp>
+#include <Utility/Alphabet.hpp>
+#include <Utility/CpuFeatures.hpp>
 
 #include <vector>
 #include <cstring>
 #include <string>
+#include <stdexcept>
+#include <unordered_map>
+#include <algorithm>
+#include <climits>
+#include <limits>
 
 namespace fastaplus {
+
+/*!
+ * XnuMarkRun function marks the run [beg,end] found on diagonal off
+ * (see the ascend/descend parameters of XNU).
+ */
+template <typename Tint>
+void XnuMarkRun(vector<unsigned char>& hit, Tint beg, Tint end, Tint off, bool ascend, bool descend){
+   for (Tint k=beg; k<=end; k++) {
+      if (ascend) hit[k] = 1;
+      if (descend) hit[k-off] = 1;
+   }
+}
+
+#if defined(FASTAPLUS_HAVE_SSE41)
+#if defined(FASTAPLUS_X86_DISPATCH)
+#pragma GCC push_options
+#pragma GCC target("sse4.1")
+#endif
+/**
+ * @brief int32 lane operations of the multi-offset XNU scan, SSE4.1.
+ */
+struct XnuLanes128{
+   typedef __m128i V;
+   static const int N = 4;
+   static V    Set1(int x)               { return _mm_set1_epi32(x); }
+   static V    Load(const int* p)        { return _mm_loadu_si128((const __m128i*) p); }
+   static void Store(int* p, V a)        { _mm_storeu_si128((__m128i*) p, a); }
+   static V    Add(V a, V b)             { return _mm_add_epi32(a, b); }
+   static V    Sub(V a, V b)             { return _mm_sub_epi32(a, b); }
+   static V    Max(V a, V b)             { return _mm_max_epi32(a, b); }
+   static V    Gt(V a, V b)              { return _mm_cmpgt_epi32(a, b); }
+   static V    And(V a, V b)             { return _mm_and_si128(a, b); }
+   static V    Or(V a, V b)              { return _mm_or_si128(a, b); }
+   static V    AndNot(V m, V a)          { return _mm_andnot_si128(m, a); }
+   static V    Blend(V a, V b, V m)      { return _mm_blendv_epi8(a, b, m); }
+   static int  Any(V m)                  { return _mm_movemask_epi8(m); }
+   static V    Widen(__m128i s8, int p){
+      switch (p){
+         case 1:  return _mm_cvtepi8_epi32(_mm_srli_si128(s8, 4));
+         case 2:  return _mm_cvtepi8_epi32(_mm_srli_si128(s8, 8));
+         case 3:  return _mm_cvtepi8_epi32(_mm_srli_si128(s8, 12));
+         default: return _mm_cvtepi8_epi32(s8);
+      }
+   }
+};
+
+#define XNU_LANES XnuLanes128
+#define XNU_SCAN_LANES XnuScanLanes128
+#include <Filters/XNULanes.hpp>
+#undef XNU_SCAN_LANES
+#undef XNU_LANES
+#if defined(FASTAPLUS_X86_DISPATCH)
+#pragma GCC pop_options
+#endif
+#endif
+
+#if defined(FASTAPLUS_HAVE_AVX2)
+#if defined(FASTAPLUS_X86_DISPATCH)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+/**
+ * @brief int32 lane operations of the multi-offset XNU scan, AVX2.
+ */
+struct XnuLanes256{
+   typedef __m256i V;
+   static const int N = 8;
+   static V    Set1(int x)               { return _mm256_set1_epi32(x); }
+   static V    Load(const int* p)        { return _mm256_loadu_si256((const __m256i*) p); }
+   static void Store(int* p, V a)        { _mm256_storeu_si256((__m256i*) p, a); }
+   static V    Add(V a, V b)             { return _mm256_add_epi32(a, b); }
+   static V    Sub(V a, V b)             { return _mm256_sub_epi32(a, b); }
+   static V    Max(V a, V b)             { return _mm256_max_epi32(a, b); }
+   static V    Gt(V a, V b)              { return _mm256_cmpgt_epi32(a, b); }
+   static V    And(V a, V b)             { return _mm256_and_si256(a, b); }
+   static V    Or(V a, V b)              { return _mm256_or_si256(a, b); }
+   static V    AndNot(V m, V a)          { return _mm256_andnot_si256(m, a); }
+   static V    Blend(V a, V b, V m)      { return _mm256_blendv_epi8(a, b, m); }
+   static int  Any(V m)                  { return _mm256_movemask_epi8(m); }
+   static V    Widen(__m128i s8, int p)  { return _mm256_cvtepi8_epi32(p ? _mm_srli_si128(s8, 8) : s8); }
+};
+
+#define XNU_LANES XnuLanes256
+#define XNU_SCAN_LANES XnuScanLanes256
+#include <Filters/XNULanes.hpp>
+#undef XNU_SCAN_LANES
+#undef XNU_LANES
+#if defined(FASTAPLUS_X86_DISPATCH)
+#pragma GCC pop_options
+#endif
+#endif
    
+static_assert(ProteinIUPAC::Size == XnuAlphaSize && ProteinIUPAC::Other == 22,
+              "XNU residue codes must index the PAM matrices");
+
 /**
  * @brief XNU filter class.
+ *
+ * All tables are set up by the constructor and only read afterwards, so
+ * one instance can be shared by threads, each passing its own Scratch.
  */
 template <typename Tint>
-class XNU : protected XnuScores{
+class XNU {
    
    Tint ascend;
    Tint descend;
    double K;
-   Tint H;
+   double H;
 
    Tint ncut;
    Tint mcut;
@@ -67,21 +176,100 @@ class XNU : protected XnuScores{
 
    char subchar;
    Tint  repeats;
+   int   simd;                              /* SimdLevel of the scan, kScalar: reference */
+   bool  truncate;                          /* true: H truncated to an integer (default) */
 
    
+   const XnuProfile* Profile;               /* matrix and its precomputed parameters */
    double Lambda;
-   vector<vector<Tint>> Mtx;
+
+   static const Tint kStride = 32;          /* padded row length of Score */
+   static const Tint kPad = 16;             /* front padding of the encoded sequence */
+   signed char   Score[32*32];              /* matrix flattened, clamped to int8 */
+   typedef AlphabetLut<ProteinIUPAC> Lut;   /* byte -> XnuAlphabet index */
+
+   Tint fallcut;
+   Tint fixedcut;                           /* topcut for scut or a fixed ncut */
+   vector<Tint> TopcutTab;                  /* topcut per noff, for short sequences (ncut=0) */
+
+   public:
+
+/**
+ * @brief Working memory of a Filter call. Reusing one Scratch across
+ * many (short) sequences avoids all per call allocations.
+ */
+   struct Scratch{
+      vector<unsigned char> iseq;           /* encoded sequence (padded) */
+      vector<unsigned char> hit;            /* masked positions */
+   };
+
+   private:
+/*!
+ * Function builds the flat scoring matrix
+ */
+   void MakeTables();
+/*!
+ * Function reads the simd parameter: F (scalar scan), sse4.1 or avx2
+ * (at most that kernel) or T (the best one the processor runs)
+ * @param val [const string&]
+ */
+   static int ParseSimd(const string& val);
+/*!
+ * Function selects the matrix profile by name (60/120/250)
+ * @param pam [const string&]
+ */
+   void SetProfile(const string& pam);
+/*!
+ * Function sets fallcut and topcut, tabulating the latter for short sequences
+ */
+   void MakeCutoffs();
+/*!
+ * Function returns the score cutoff for a given number of offsets
+ * @param noff [Tint]
+ */
+   Tint TopCut(Tint noff) const;
+/*!
+ * Function computes the score cutoff for a given number of offsets
+ * @param noff [Tint]
+ */
+   Tint ScoreCut(Tint noff) const;
+/*!
+ * Function uppercases a sequence and masks the hit positions
+ * @param str [string&]
+ * @param hit [const vector<unsigned char>&]
+ */
+   void ApplyHits(string& str, const vector<unsigned char>& hit) const;
+/*!
+ * Function marks the positions hit by an internal repeat
+ * @param str [const string&]
+ * @param sc [Scratch&] // hit is resized to the sequence length
+ */
+   void Hits(const string& str, Scratch& sc) const;
 /*!
- * Function returns the index value associated to the AA alphabet
- * @param ch [char] // AA character
- * @param Alph [const string&] // "ARNDCQEGHILKMFPSTWYVBZX*-"
+ * Function marks the positions hit by an internal repeat of an encoded sequence
+ * @param enc [const unsigned char*] // residue codes
+ * @param n [Tint] // sequence length
+ * @param sc [Scratch&]
  */
-   Tint AlphaToNum(char ch,  string Alph);
+   void Hits(const unsigned char* enc, Tint n, Scratch& sc) const;
 /*!
- * Function sets the expected parameters given a chosen matrix
- * @param f [vector<double>&] 
+ * Function scans the sequence encoded in sc.iseq
+ * @param sc [Scratch&]
+ * @param n [Tint] // sequence length
  */
-   double EInfo(vector<double>& f);
+   void Scan(Scratch& sc, Tint n) const;
+/*!
+ * Function collects the masked positions as sorted closed intervals
+ * @param hit [const vector<unsigned char>&]
+ * @param n [Tint] // sequence length
+ */
+   vector<Interval<Tint>> HitsToIntervals(const vector<unsigned char>& hit, Tint n) const;
+/*!
+ * Function scans the diagonals mcut..noff one after another (reference)
+ * @param iseq [const unsigned char*] // encoded sequence
+ * @param n [Tint] // sequence length
+ */
+   void ScanScalar(const unsigned char* iseq, Tint n, Tint noff, Tint topcut, Tint fallcut, vector<unsigned char>& hit) const;
    
    public:
    
@@ -105,19 +293,67 @@ class XNU : protected XnuScores{
 /*! Function executing filtering procedure 
  * @param str [const string&] 
  */
-  string Filter(const string& str); 
+  string Filter(const string& str) const; 
+/*! Function executing filtering procedure on a given sequence in place
+ * @param str [string&] 
+ */
+  void FilterInPlace(string& str) const; 
+/*! Function returns masked positions as a list of sorted closed intervals
+ * @param str [const string&] 
+ */
+  vector<Interval<Tint>> Mask(const string& str) const; 
+/*! Function returns masked positions of a sequence already translated by Encode
+ * @param enc [const unsigned char*] 
+ * @param n [Tint] 
+ * @param sc [Scratch&] 
+ */
+  vector<Interval<Tint>> Mask(const unsigned char* enc, Tint n, Scratch& sc) const; 
+/*! Function uppercases a sequence and masks the given intervals, as FilterInPlace does
+ * @param str [string&] 
+ * @param ivs [const vector<Interval<Tint>>&] 
+ */
+  void Apply(string& str, const vector<Interval<Tint>>& ivs) const; 
+/*! Function translates a sequence into the residue codes (Alphabet index) used by XNU
+ * @param str [const string&] 
+ * @param enc [vector<unsigned char>&] 
+ */
+  void Encode(const string& str, vector<unsigned char>& enc) const; 
+/*! Function returns the residue code of a single character
+ * @param c [char] 
+ */
+  unsigned char CodeOf(char c) const; 
+/*! Function returns the parameters that determine Mask, as a string (used to key cached results)
+ */
+  string Signature() const; 
+/*! Function returns masked positions as a per position mask
+ * @param str [const string&] 
+ */
+  vector<bool> MaskBits(const string& str) const; 
+/*! Function executing filtering procedure on a batch of sequences
+ * @param seqs [const vector<string>&] 
+ */
+  vector<string> Filter(const vector<string>& seqs) const; 
+/*! Function executing filtering procedure on a batch of sequences in place
+ * @param seqs [vector<string>&] 
+ */
+  void FilterInPlace(vector<string>& seqs) const; 
+/*! Function executing filtering procedure in place using a given working memory
+ * @param str [string&] 
+ * @param sc [Scratch&] 
+ */
+  void FilterInPlace(string& str, Scratch& sc) const; 
    
 };
 
 template <typename Tint>
-XNU<Tint>::XNU():subchar('X'),scut(0), pcut(0.01), repeats(0), mcut(1), ncut(4), descend(1), ascend(1),K(0.2), XnuScores(){
-   Lambda = this->Lambda60;
-   Mtx    = this->Pam60;
-   H = EInfo(this->Dayhoff);   
+XNU<Tint>::XNU():ascend(1), descend(1), K(0.2), ncut(4), mcut(1), pcut(0.01), scut(0), subchar('X'), repeats(0), simd(CpuSimdLevel()), truncate(true){
+   SetProfile("PAM60");
+   MakeTables();
+   MakeCutoffs();
 };
 
 template <typename Tint>
-XNU<Tint>::XNU(unordered_map<string,string>& Arg):XnuScores(){
+XNU<Tint>::XNU(unordered_map<string,string>& Arg){
    subchar   = (Arg.find("subchar") !=Arg.end()) ? Arg["subchar"][0]                     : 'X';
    scut      = (Arg.find("scut") !=Arg.end())    ? StringToNumeric<Tint>(Arg["scut"])    : 0;
    pcut      = (Arg.find("pcut") !=Arg.end())    ? StringToNumeric<double>(Arg["pcut"]) : 0.01;
@@ -126,26 +362,19 @@ XNU<Tint>::XNU(unordered_map<string,string>& Arg):XnuScores(){
    ncut      = (Arg.find("ncut") !=Arg.end())    ? StringToNumeric<Tint>(Arg["ncut"])    : 4;
    descend   = (Arg.find("descend") !=Arg.end()) ? StringToNumeric<Tint>(Arg["descend"]) : 1;
    ascend    = (Arg.find("ascend") !=Arg.end())  ? StringToNumeric<Tint>(Arg["ascend"])  : 1;
-   
-   if (Arg.find("pam") !=Arg.end()){
-      if(Arg["pam"].compare("PAM60") == 0){
-         Lambda = this->Lambda60;
-         Mtx    = this->Pam60;
-      }else if(Arg["pam"].compare("PAM12") == 0){
-         Lambda = this->Lambda120;
-         Mtx    = this->Pam120;
-      }else if(Arg["pam"].compare("PAM250") == 0){
-         Lambda = this->Lambda250;
-         Mtx    = this->Pam250;
-      }
-   }else{
-      Lambda = this->Lambda60;
-      Mtx    = this->Pam60;
-   }
+   simd      = (Arg.find("simd") !=Arg.end())    ? ParseSimd(Arg["simd"])                : CpuSimdLevel();
+   truncate  = (Arg.find("truncate_h") !=Arg.end()) ? StringToBool(Arg["truncate_h"])    : true;
+
+   if (mcut < 1)
+      throw runtime_error ("XNU: the first scanned offset (mcut) has to be at least 1!");
+   if (ncut > 0 && mcut > ncut)
+      throw runtime_error ("XNU: the first scanned offset (mcut) is beyond the last one (ncut)!");
    
    
    K = 0.2;
-   H = EInfo(this->Dayhoff);
+   SetProfile((Arg.find("pam") !=Arg.end()) ? Arg["pam"] : "PAM60");
+   MakeTables();
+   MakeCutoffs();
    
 
 }
@@ -154,62 +383,245 @@ template <typename Tint>
 XNU<Tint>::~XNU(){};
 
 template <typename Tint>
-double XNU<Tint>::EInfo(vector<double>& f){
+int XNU<Tint>::ParseSimd(const string& val){
+   if (val == "sse4.1")
+      return min((int) kSse41, CpuSimdLevel());
+   if (val == "avx2")
+      return min((int) kAvx2, CpuSimdLevel());
+   return StringToBool(val) ? CpuSimdLevel() : (int) kScalar;
+}
 
-	double sum,tot,fij,eij;
+/* H is truncated to an integer by default, as XNU has always done. For
+ * PAM120 and PAM250 that makes it 0 and their topcut unbounded (see
+ * ScoreCut), so every repeat is masked; truncate_h=F uses H itself.
+ */
+template <typename Tint>
+void XNU<Tint>::SetProfile(const string& pam){
+   if (pam == "PAM60" || pam == "60")
+      Profile = &XnuProfiles[0];
+   else if (pam == "PAM120" || pam == "PAM12" || pam == "120")
+      Profile = &XnuProfiles[1];
+   else if (pam == "PAM250" || pam == "250")
+      Profile = &XnuProfiles[2];
+   else
+      throw runtime_error ("Unknown PAM matrix: " + pam);
+
+   Lambda = Profile->lambda;
+   H      = truncate ? floor(Profile->h) : Profile->h;
+}
 
-	sum = tot = 0.0;
+/* The '-' row/column holds -999999. A single step of -128 already
+ * exceeds any fallcut (< 128 for all supported matrices), so clamping to
+ * int8 terminates the diagonal run exactly like the original value.
+ */
+template <typename Tint>
+void XNU<Tint>::MakeTables(){
+   for (Tint i=0; i<kStride*kStride; i++)
+      Score[i] = -128;
+   for (Tint i=0; i<XnuAlphaSize; i++)
+      for (Tint j=0; j<XnuAlphaSize; j++)
+         Score[i*kStride+j] = static_cast<signed char>(max(-128, min(127, Profile->pam[i][j])));
+}
 
-	for (Tint i=0; i<Mtx.size()-5; i++)
-	   for (Tint j=0; j<Mtx.size()-5; j++) {
+/* fallcut only depends on the matrix and topcut for the default pcut
+ * and ncut (with the exact H) is part of its profile. Otherwise topcut depends on the number
+ * of scanned offsets, which is fixed by ncut or, with ncut=0, by the
+ * sequence length; the latter case is tabulated for lengths up to 1024.
+ */
+template <typename Tint>
+void XNU<Tint>::MakeCutoffs(){
+   const Tint kTab = 1024;
+
+   fallcut = Profile->fallcut;
+
+   TopcutTab.clear();
+   if (scut != 0)
+      fixedcut = scut;
+   else if (ncut > 0)
+      fixedcut = (pcut == 0.01 && ncut == 4) ? static_cast<Tint>(truncate ? Profile->topcut : Profile->exactcut)
+                                             : ScoreCut(ncut);
+   else
+      for (Tint noff=0; noff<kTab; noff++)
+         TopcutTab.push_back(ScoreCut(noff));
+}
 
-   		fij = f[i]*f[j];
-	   	tot += fij;
+template <typename Tint>
+Tint XNU<Tint>::TopCut(Tint noff) const{
+	if (scut!=0 || ncut>0)
+		return fixedcut;
+	if (noff>=0 && (size_t) noff<TopcutTab.size())
+		return TopcutTab[noff];
+	return ScoreCut(noff);
+}
 
-		   eij = Mtx[i][j]*fij*exp(Lambda*Mtx[i][j]);
-		   sum += eij;
-	   }
+/* With H = 0 (truncated) the log is -inf and s0 is +inf. The original
+ * code converted that to an integer, which is undefined and gives the
+ * smallest int on x86; the same value is now returned explicitly.
+ */
+template <typename Tint>
+Tint XNU<Tint>::ScoreCut(Tint noff) const{
+	double s0;
 
-	return(Lambda*sum/tot);
+	s0 = 0 - log( pcut*H / (noff*K) ) / Lambda;
+	if (std::isinf(s0) && s0>0)
+		return numeric_limits<Tint>::min();
+	if (s0>0)
+		return floor(s0 + log(s0)/Lambda + 0.5);
+	return 0;
 }
 
+
+
 template <typename Tint>
-Tint  XNU<Tint>::AlphaToNum(char ch,  string Alph){
-   /* no lower characters !!!! */
-        char *p;
-        if (isupper(Alph[0]) && islower(ch)) ch = toupper(ch);
-        if (islower(Alph[0]) && isupper(ch)) ch = tolower(ch);
-        p = strchr(&Alph[0],ch);
-        return (p != NULL) ? (p - &Alph[0]) : (22);
+string XNU<Tint>::Filter(const string& s) const{
+   string str = s;
+   FilterInPlace(str);
+   return str;
 }
 
+template <typename Tint>
+void XNU<Tint>::FilterInPlace(string& str) const{
+   Scratch sc;
+   FilterInPlace(str, sc);
+}
 
+template <typename Tint>
+void XNU<Tint>::FilterInPlace(string& str, Scratch& sc) const{
+   Hits(str, sc);
+   ApplyHits(str, sc.hit);
+}
 
 template <typename Tint>
-string XNU<Tint>::Filter(const string& s){
-   
-	Tint off = 0,sum = 0,beg = 0,end= 0,top= 0,noff=0;
-	Tint topcut=0,fallcut=0;
-   string str = s;
-	double s0;
+vector<string> XNU<Tint>::Filter(const vector<string>& seqs) const{
+   vector<string> out(seqs);
+   FilterInPlace(out);
+   return out;
+}
+
+template <typename Tint>
+void XNU<Tint>::FilterInPlace(vector<string>& seqs) const{
+   Scratch sc;
+   for (size_t i=0; i<seqs.size(); i++)
+      FilterInPlace(seqs[i], sc);
+}
+
+template <typename Tint>
+void XNU<Tint>::ApplyHits(string& str, const vector<unsigned char>& hit) const{
+   for (size_t i=0; i<str.size(); i++){
+      char c = toupper(str[i]);
+      if (hit[i] ^ repeats)
+         c = (subchar != 0) ? subchar : tolower(c);
+      str[i] = c;
+   }
+}
+
+template <typename Tint>
+vector<Interval<Tint>> XNU<Tint>::Mask(const string& str) const{
+   Scratch sc;
+   Hits(str, sc);
+   return HitsToIntervals(sc.hit, str.size());
+}
+
+template <typename Tint>
+vector<Interval<Tint>> XNU<Tint>::Mask(const unsigned char* enc, Tint n, Scratch& sc) const{
+   Hits(enc, n, sc);
+   return HitsToIntervals(sc.hit, n);
+}
+
+template <typename Tint>
+void XNU<Tint>::Apply(string& str, const vector<Interval<Tint>>& ivs) const{
+   for (size_t i=0; i<str.size(); i++)
+      str[i] = toupper(str[i]);
+   ApplyMask(str, ivs, subchar);
+}
+
+template <typename Tint>
+void XNU<Tint>::Encode(const string& str, vector<unsigned char>& enc) const{
+   Lut::Encode(str, enc);
+}
+
+template <typename Tint>
+unsigned char XNU<Tint>::CodeOf(char c) const{
+   return Lut::code[(unsigned char) c];
+}
+
+template <typename Tint>
+string XNU<Tint>::Signature() const{
+   return string("XNU/") + Profile->name + "/" + NumericToString(scut) + "/" + NumericToString(pcut)
+        + "/" + NumericToString(ncut) + "/" + NumericToString(mcut) + "/" + NumericToString(ascend)
+        + "/" + NumericToString(descend) + "/" + NumericToString(repeats) + "/" + NumericToString(K) + (truncate ? "" : "/exact_h");
+}
+
+template <typename Tint>
+vector<Interval<Tint>> XNU<Tint>::HitsToIntervals(const vector<unsigned char>& hit, Tint n) const{
+   vector<Interval<Tint>> ivs;
+
+   for (Tint i=0; i<n; i++) {
+      if (hit[i] ^ repeats) {
+         Interval<Tint> iv = {i, i};
+         while (iv.end+1 < n && (hit[iv.end+1] ^ repeats))
+            iv.end++;
+         ivs.push_back(iv);
+         i = iv.end;
+      }
+   }
+   return ivs;
+}
+
+template <typename Tint>
+vector<bool> XNU<Tint>::MaskBits(const string& str) const{
+   return IntervalsToBits(Mask(str), str.size());
+}
+
+template <typename Tint>
+void XNU<Tint>::Hits(const string& str, Scratch& sc) const{
    
-   vector<Tint> iseq(str.size()+1,0);
-   vector<Tint> hit(str.size()+1,0);
+	Tint n = str.size();
    
-	for (Tint i=0; i<str.size(); i++){
-      iseq[i] = AlphaToNum(str[i], this->Alphabet);
-   }
-	noff = str.size()-1;
+   sc.iseq.assign(kPad+n+1,22);
+   Lut::Encode(str.data(), sc.iseq.data() + kPad, n);
+   Scan(sc, n);
+}
+
+template <typename Tint>
+void XNU<Tint>::Hits(const unsigned char* enc, Tint n, Scratch& sc) const{
+   sc.iseq.assign(kPad+n+1,22);
+   memcpy(sc.iseq.data() + kPad, enc, n);
+   Scan(sc, n);
+}
+
+template <typename Tint>
+void XNU<Tint>::Scan(Scratch& sc, Tint n) const{
+	Tint noff=0;
+	Tint topcut=0;
+   vector<unsigned char>& hit = sc.hit;
+   const unsigned char* iseq = sc.iseq.data() + kPad;
+
+   hit.assign(n+1,0);
+	noff = n-1;
 	if (ncut>0) noff=ncut;
    
-	if (scut!=0) {
-		topcut = scut;
-	} else {
-		s0 = 0 - log( pcut*H / (noff*K) ) / Lambda;
-		if (s0>0) topcut = floor(s0 + log(s0)/Lambda + 0.5);
-		else topcut = 0;
-	}
-	fallcut = static_cast<Tint>(log(K/0.001)/Lambda);
+	topcut = TopCut(noff);
+
+#if defined(FASTAPLUS_HAVE_SSE41)
+   if (simd >= kSse41 && n < INT_MAX/2 && fallcut >= 0){
+      for (Tint off0=mcut; off0<=noff; off0+=16)
+#if defined(FASTAPLUS_HAVE_AVX2)
+         if (simd >= kAvx2)
+            XnuScanLanes256(Score, ascend != 0, descend != 0, iseq, n, off0, noff, topcut, fallcut, hit);
+         else
+#endif
+            XnuScanLanes128(Score, ascend != 0, descend != 0, iseq, n, off0, noff, topcut, fallcut, hit);
+      return;
+   }
+#endif
+   ScanScalar(iseq, n, noff, topcut, fallcut, hit);
+}
+
+template <typename Tint>
+void XNU<Tint>::ScanScalar(const unsigned char* iseq, Tint n, Tint noff, Tint topcut, Tint fallcut, vector<unsigned char>& hit) const{
+
+	Tint sum = 0,beg = 0,end= 0,top= 0;
 
 	for (Tint off=mcut; off<=noff; off++) {
 
@@ -217,17 +629,14 @@ string XNU<Tint>::Filter(const string& s){
       beg=off;
       end=0;
 
-		for (Tint i=off; i<str.size(); i++) {
-			sum += Mtx[iseq[i]][iseq[i-off]];
+		for (Tint i=off; i<n; i++) {
+			sum += Score[iseq[i]*kStride + iseq[i-off]];
 			if (sum>top) {
 				top=sum;
 				end=i;
 			}
 			if (top>=topcut && top-sum>fallcut) {
-				for (Tint k=beg; k<=end; k++) {
-					if (ascend) hit[k] = 1;
-					if (descend) hit[k-off] = 1;
-				}
+				XnuMarkRun(hit, beg, end, off, ascend != 0, descend != 0);
 				sum=top=0;
 				beg=end=i+1;
 			} else if (top-sum>fallcut) {
@@ -239,27 +648,12 @@ string XNU<Tint>::Filter(const string& s){
 				sum=top=0;
 			}
 		}
-		if (top>=topcut) {
-			for (Tint k=beg; k<=end; k++) {
-				if (ascend) hit[k] = 1;
-				if (descend) hit[k-off] = 1;
-			}
-		}
+		if (top>=topcut)
+			XnuMarkRun(hit, beg, end, off, ascend != 0, descend != 0);
 	}
-
-	for (Tint i=0; i<str.size(); i++) {
-		str[i] = toupper(str[i]);
-		if (hit[i] ^ repeats) {
-			if (subchar==0) {
-				str[i] = tolower(str[i]);
-			} else {
-				str[i] = subchar;
-			}
-		}
-	}
-   
-   return str;
-   
 }
 
+
 }
+
+#endif
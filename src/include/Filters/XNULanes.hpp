@@ -0,0 +1,116 @@
+/*
+ * XNULanes.hpp
+ *
+ * Copyright 2016 Robert Bakaric <rbakaric@irb.hr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+
+/* No include guard: XNU.hpp includes this file (inside namespace
+ * fastaplus) once per instruction set, each time in a #pragma GCC target region (see CpuFeatures.hpp) and
+ * with XNU_LANES naming the lane operations and XNU_SCAN_LANES the
+ * function to define.
+ *
+ * XNU_SCAN_LANES scans the 16 diagonals off0..off0+15 (up to noff)
+ * together; iseq needs 16 bytes of front padding and Score is the int8
+ * matrix with rows of 32.
+ *
+ * Lane k holds diagonal off0+15-k, so the 16 residues it pairs with
+ * residue i are simply iseq[i-off0-15 .. i-off0]. Their scores come from
+ * the int8 row of residue i through two pshufb lookups (columns 0-15 and
+ * 16-31) and are widened to int32 sums. Each lane runs exactly the
+ * scalar recurrence; lanes whose diagonal has not started yet (i < off)
+ * or lies beyond noff get a zero score, which leaves their state
+ * (sum=top=0, beg=off, end=0) untouched as long as fallcut >= 0.
+ * Completed runs are rare and are marked lane by lane.
+ */
+
+template <typename Tint>
+void XNU_SCAN_LANES(const signed char* Score, bool ascend, bool descend, const unsigned char* iseq,
+                    Tint n, Tint off0, Tint noff, Tint topcut, Tint fallcut, vector<unsigned char>& hit){
+   typedef XNU_LANES L;
+   typedef typename L::V V;
+   const int kStride = 32;
+   const int P = 16 / L::N;
+
+   int offs[16], begs[L::N], ends[L::N], flags[L::N];
+   V sum[P], top[P], beg[P], end[P], off[P];
+   const V zero = L::Set1(0);
+   const V fc = L::Set1(fallcut);
+   const V tc = L::Set1(topcut);
+   const __m128i fifteen = _mm_set1_epi8(15);
+
+   for (int k=0; k<16; k++)
+      offs[k] = (off0+15-k <= noff) ? off0+15-k : INT_MAX;
+   for (int p=0; p<P; p++){
+      off[p] = L::Load(offs + p*L::N);
+      sum[p] = top[p] = end[p] = zero;
+      beg[p] = off[p];
+   }
+
+/* until all lanes have started, scores of idle lanes are masked */
+   Tint ramp = (off0+15 <= noff) ? off0+15 : n;
+
+/* vectors holding only offsets beyond noff (short ncut) are skipped */
+   int p0 = 0;
+   while (p0 < P-1 && off0+15-(p0*L::N+L::N-1) > noff)
+      p0++;
+
+   for (Tint i=off0; i<n; i++){
+      __m128i b  = _mm_loadu_si128((const __m128i*) (iseq + i - off0 - 15));
+      const signed char* row = Score + iseq[i]*kStride;
+      __m128i lo = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) row), b);
+      __m128i hi = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*) (row+16)), b);
+      __m128i s8 = _mm_blendv_epi8(lo, hi, _mm_cmpgt_epi8(b, fifteen));
+      const V iv = L::Set1(i);
+      const V nx = L::Set1(i+1);
+
+      for (int p=p0; p<P; p++){
+         V s = L::Widen(s8, p);
+         if (i < ramp)
+            s = L::And(s, L::Gt(nx, off[p]));
+         sum[p] = L::Add(sum[p], s);
+         end[p] = L::Blend(end[p], iv, L::Gt(sum[p], top[p]));
+         top[p] = L::Max(top[p], sum[p]);
+         V fall = L::Gt(L::Sub(top[p], sum[p]), fc);
+         V fire = L::AndNot(L::Gt(tc, top[p]), fall);
+         if (L::Any(fire)){
+            L::Store(begs, beg[p]);
+            L::Store(ends, end[p]);
+            L::Store(flags, fire);
+            for (int k=0; k<L::N; k++)
+               if (flags[k])
+                  XnuMarkRun(hit, begs[k], ends[k], offs[p*L::N+k], ascend, descend);
+         }
+         V reset = L::Or(fall, L::Gt(zero, sum[p]));
+         sum[p] = L::AndNot(reset, sum[p]);
+         top[p] = L::AndNot(reset, top[p]);
+         beg[p] = L::Blend(beg[p], nx, reset);
+         end[p] = L::Blend(end[p], nx, reset);
+      }
+   }
+
+   for (int p=p0; p<P; p++){
+      L::Store(begs, beg[p]);
+      L::Store(ends, end[p]);
+      L::Store(flags, L::AndNot(L::Gt(tc, top[p]), L::Gt(L::Set1(1), zero)));
+      for (int k=0; k<L::N; k++)
+         if (flags[k] && offs[p*L::N+k] != INT_MAX)
+            XnuMarkRun(hit, begs[k], ends[k], offs[p*L::N+k], ascend, descend);
+   }
+}
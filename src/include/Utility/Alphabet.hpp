@@ -0,0 +1,166 @@
+/*
+ * Alphabet.hpp
+ *
+ * Copyright 2016 Robert Bakaric <rbakaric@irb.hr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+
+#ifndef FASTAPLUS_UTILITY_ALPHABET_HPP
+#define FASTAPLUS_UTILITY_ALPHABET_HPP
+
+#include <string>
+#include <vector>
+#include <Filters/Encode.hpp>
+
+/** @file Alphabet.hpp
+ * Residue alphabets and their compile time byte -> code tables, shared by
+ * FastaCorp and the filters.
+ */
+
+using namespace std;
+
+namespace fastaplus {
+
+/*!
+ * AlphaFind function returns the position of c in the zero terminated
+ * string s (searching from i), or -1.
+ */
+constexpr int AlphaFind(const char* s, int c, int i){
+   return s[i] == 0 ? -1 : (s[i] == c ? i : AlphaFind(s, c, i+1));
+}
+
+/*!
+ * AlphaUpper function converts an ASCII lower case letter to upper case.
+ */
+constexpr int AlphaUpper(int c){
+   return (c >= 'a' && c <= 'z') ? c - 32 : c;
+}
+
+/**
+ * @brief The 20 standard amino acids (SEG order). Anything else is X.
+ */
+struct Protein20{
+   enum { Size = 20, Other = 20 };
+   static constexpr const char* Letters(){ return "ACDEFGHIKLMNPQRSTVWY"; }
+   static constexpr unsigned char Code(int c){
+      return AlphaFind(Letters(), c, 0) < 0 ? (unsigned char) Other : (unsigned char) AlphaFind(Letters(), c, 0);
+   }
+};
+
+/**
+ * @brief Amino acids with the IUPAC ambiguity codes, stop and gap, in the
+ * order of the XNU/PAM matrices. Anything else is X.
+ */
+struct ProteinIUPAC{
+   enum { Size = 25, Other = 22 };
+   static constexpr const char* Letters(){ return "ARNDCQEGHILKMFPSTWYVBZX*-"; }
+   static constexpr unsigned char Code(int c){
+      return AlphaFind(Letters(), c, 0) < 0 ? (unsigned char) Other : (unsigned char) AlphaFind(Letters(), c, 0);
+   }
+};
+
+/**
+ * @brief The four nucleotides. Anything else (N) gets code 4.
+ */
+struct DNA4{
+   enum { Size = 4, Other = 4 };
+   static constexpr const char* Letters(){ return "ACGT"; }
+   static constexpr unsigned char Code(int c){
+      return AlphaFind(Letters(), c, 0) < 0 ? (unsigned char) Other : (unsigned char) AlphaFind(Letters(), c, 0);
+   }
+};
+
+/**
+ * @brief Nucleotides with the IUPAC ambiguity codes; U is read as T.
+ * Anything else is N.
+ */
+struct DNAIUPAC{
+   enum { Size = 15, Other = 14 };
+   static constexpr const char* Letters(){ return "ACGTRYSWKMBDHVN"; }
+   static constexpr unsigned char Code(int c){
+      return c == 'U' ? (unsigned char) 3 :
+             AlphaFind(Letters(), c, 0) < 0 ? (unsigned char) Other : (unsigned char) AlphaFind(Letters(), c, 0);
+   }
+};
+
+/**
+ * @brief Any Latin letter, as used by CleanCorp: codes 0..25 for A..Z,
+ * Space for white space and Other for anything else.
+ */
+struct Latin26{
+   enum { Size = 26, Other = 26, Space = 27 };
+   static constexpr const char* Letters(){ return "ABCDEFGHIJKLMNOPQRSTUVWXYZ"; }
+   static constexpr unsigned char Code(int c){
+      return (c == ' ' || (c >= '\t' && c <= '\r')) ? (unsigned char) Space :
+             AlphaFind(Letters(), c, 0) < 0 ? (unsigned char) Other : (unsigned char) AlphaFind(Letters(), c, 0);
+   }
+};
+
+
+/* 0..N-1 as a parameter pack */
+template <unsigned... I> struct ByteSeq {};
+template <unsigned N, unsigned... I> struct MakeByteSeq : MakeByteSeq<N-1, N-1, I...> {};
+template <unsigned... I> struct MakeByteSeq<0, I...> { typedef ByteSeq<I...> type; };
+
+template <typename Alpha, bool FoldCase, typename Seq> struct AlphabetTable;
+
+template <typename Alpha, bool FoldCase, unsigned... I>
+struct AlphabetTable<Alpha, FoldCase, ByteSeq<I...>>{
+   static constexpr unsigned char code[sizeof...(I)] = { Alpha::Code(FoldCase ? AlphaUpper(I) : (int) I)... };
+};
+
+template <typename Alpha, bool FoldCase, unsigned... I>
+constexpr unsigned char AlphabetTable<Alpha, FoldCase, ByteSeq<I...>>::code[sizeof...(I)];
+
+/**
+ * @brief Byte -> residue code table of an alphabet, built at compile time.
+ *
+ * With FoldCase lower case letters get the code of their upper case form,
+ * otherwise they are Other.
+ */
+template <typename Alpha, bool FoldCase = true>
+struct AlphabetLut : AlphabetTable<Alpha, FoldCase, typename MakeByteSeq<256>::type> {
+
+   typedef AlphabetTable<Alpha, FoldCase, typename MakeByteSeq<256>::type> Table;
+
+/*!
+ * Encode function translates N bytes of Src into residue codes.
+ * @param Src [const char*]
+ * @param Dst [unsigned char*]
+ * @param N [size_t]
+ */
+   static void Encode(const char* Src, unsigned char* Dst, size_t N){
+      static const bool simd = LutIsLetterOnly(Table::code, (unsigned char) Alpha::Other);
+      EncodeBytes(Table::code, simd, (unsigned char) Alpha::Other, (const unsigned char*) Src, Dst, N);
+   }
+
+/*!
+ * Encode function overload translating a whole string.
+ * @param Str [const string&]
+ * @param Enc [vector<unsigned char>&] // resized to the string length
+ */
+   static void Encode(const string& Str, vector<unsigned char>& Enc){
+      Enc.resize(Str.size());
+      Encode(Str.data(), Enc.data(), Str.size());
+   }
+};
+
+}
+
+#endif
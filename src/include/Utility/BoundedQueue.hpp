@@ -0,0 +1,106 @@
+/*
+ * BoundedQueue.hpp
+ *
+ * Copyright 2016 Robert Bakaric <rbakaric@irb.hr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+
+#ifndef FASTAPLUS_UTILITY_BOUNDEDQUEUE_HPP
+#define FASTAPLUS_UTILITY_BOUNDEDQUEUE_HPP
+
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+
+/** @file BoundedQueue.hpp
+ * Blocking queue of limited capacity connecting the stages of a streaming
+ * program (reader -> workers -> writer).
+ */
+
+using namespace std;
+
+namespace fastaplus {
+
+/**
+ * @brief Multi producer, multi consumer FIFO holding at most Capacity items.
+ */
+template <typename T>
+class BoundedQueue {
+
+   deque<T> Items;
+   size_t   Capacity;
+   bool     Closed;
+   mutex    Lock;
+   condition_variable NotFull;
+   condition_variable NotEmpty;
+
+   public:
+
+/*!
+ * BoundedQueue class constructor.
+ * @param capacity [size_t] // at least 1
+ */
+   BoundedQueue(size_t capacity):Capacity(capacity ? capacity : 1), Closed(false){}
+
+/*!
+ * Push function appends an item, waiting while the queue is full. Returns
+ * false (dropping the item) if the queue has been closed.
+ * @param item [T]
+ */
+   bool Push(T item){
+      unique_lock<mutex> lk(Lock);
+      NotFull.wait(lk, [this]{ return Closed || Items.size() < Capacity; });
+      if (Closed)
+         return false;
+      Items.push_back(std::move(item));
+      NotEmpty.notify_one();
+      return true;
+   }
+
+/*!
+ * Pop function removes the oldest item, waiting while the queue is empty.
+ * Returns false once the queue is closed and drained.
+ * @param item [T&]
+ */
+   bool Pop(T& item){
+      unique_lock<mutex> lk(Lock);
+      NotEmpty.wait(lk, [this]{ return Closed || !Items.empty(); });
+      if (Items.empty())
+         return false;
+      item = std::move(Items.front());
+      Items.pop_front();
+      NotFull.notify_one();
+      return true;
+   }
+
+/*!
+ * Close function wakes all waiting threads. Items already queued can
+ * still be popped, further pushes fail.
+ */
+   void Close(){
+      lock_guard<mutex> lk(Lock);
+      Closed = true;
+      NotFull.notify_all();
+      NotEmpty.notify_all();
+   }
+};
+
+}
+
+#endif
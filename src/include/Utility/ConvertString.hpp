@@ -21,8 +21,12 @@
  * 
  */
 
+#ifndef FASTAPLUS_UTILITY_CONVERTSTRING_HPP
+#define FASTAPLUS_UTILITY_CONVERTSTRING_HPP
+
 #include <string>
 #include <sstream>
+#include <cctype>
 
 using namespace std;
 
@@ -42,6 +46,41 @@ inline Tnum StringToNumeric(const string& str){
    ss << str; ss >> num;
    return num;
 }
+/*!
+ * NumericToString function converts a numeric value to a string that
+ * reads back to the same value
+ * @param  num [Tnum]
+ */
+
+template<typename Tnum>
+inline string NumericToString(Tnum num){
+
+   stringstream ss;
+
+   ss.precision(17);
+   ss << num;
+   return ss.str();
+}
+/*!
+ * StringToSize function converts a size with an optional K, M or G suffix
+ * (powers of 1024) to bytes, e.g. 64K or 2G
+ * @param  str [const string&]
+ */
+inline unsigned long StringToSize(const string& str){
+
+   unsigned long mult = 1;
+   string num(str);
+   if (num.size() > 0){
+      switch (toupper(num[num.size()-1])){
+         case 'K': mult = 1UL << 10; break;
+         case 'M': mult = 1UL << 20; break;
+         case 'G': mult = 1UL << 30; break;
+      }
+      if (mult > 1)
+         num.resize(num.size()-1);
+   }
+   return StringToNumeric<unsigned long>(num) * mult;
+}
 /*!
  * StringToBool function converts a numeric value to a bool
  * @param  str [const string&]
@@ -52,3 +91,5 @@ inline bool StringToBool(const string& str){
 }
 
 }
+
+#endif
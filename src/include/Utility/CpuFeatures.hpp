@@ -0,0 +1,90 @@
+/*
+ * CpuFeatures.hpp
+ *
+ * Copyright 2016 Robert Bakaric <rbakaric@irb.hr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+
+#ifndef FASTAPLUS_UTILITY_CPUFEATURES_HPP
+#define FASTAPLUS_UTILITY_CPUFEATURES_HPP
+
+/** @file CpuFeatures.hpp
+ * Instruction sets available to the SIMD kernels.
+ *
+ * With GCC on x86 the kernels are compiled for their instruction set
+ * (#pragma GCC target) whatever the build flags are, and CpuSimdLevel
+ * picks one at run time, so a plain ./configure && make build uses them.
+ * Other compilers get the kernels the build flags enable (e.g. -mavx2).
+ */
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__) && !defined(__clang__)
+#define FASTAPLUS_X86_DISPATCH 1
+#endif
+
+#if defined(FASTAPLUS_X86_DISPATCH) || defined(__SSSE3__)
+#define FASTAPLUS_HAVE_SSSE3 1
+#endif
+#if defined(FASTAPLUS_X86_DISPATCH) || defined(__SSE4_1__)
+#define FASTAPLUS_HAVE_SSE41 1
+#endif
+#if defined(FASTAPLUS_X86_DISPATCH) || defined(__AVX2__)
+#define FASTAPLUS_HAVE_AVX2 1
+#endif
+
+#if defined(FASTAPLUS_HAVE_SSSE3)
+#include <immintrin.h>
+#endif
+
+namespace fastaplus {
+
+/*! SIMD levels, each implying the ones below it */
+enum SimdLevel { kScalar = 0, kSsse3 = 1, kSse41 = 2, kAvx2 = 3 };
+
+/*!
+ * CpuSimdLevel function returns the highest SimdLevel that is both
+ * compiled in and supported by the processor.
+ */
+inline int CpuSimdLevel(){
+#if defined(FASTAPLUS_X86_DISPATCH)
+   static const int level = __builtin_cpu_supports("avx2")   ? kAvx2  :
+                            __builtin_cpu_supports("sse4.1") ? kSse41 :
+                            __builtin_cpu_supports("ssse3")  ? kSsse3 : kScalar;
+   return level;
+#elif defined(__AVX2__)
+   return kAvx2;
+#elif defined(__SSE4_1__)
+   return kSse41;
+#elif defined(__SSSE3__)
+   return kSsse3;
+#else
+   return kScalar;
+#endif
+}
+
+/*!
+ * SimdLevelName function returns the name of a SimdLevel.
+ * @param Level [int]
+ */
+inline const char* SimdLevelName(int Level){
+   return Level >= kAvx2 ? "AVX2" : Level >= kSse41 ? "SSE4.1" : Level >= kSsse3 ? "SSSE3" : "scalar";
+}
+
+}
+
+#endif
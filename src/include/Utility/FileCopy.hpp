@@ -0,0 +1,144 @@
+/*
+ * FileCopy.hpp
+ *
+ * Copyright 2016 Robert Bakaric <rbakaric@irb.hr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+
+#ifndef FASTAPLUS_UTILITY_FILECOPY_HPP
+#define FASTAPLUS_UTILITY_FILECOPY_HPP
+
+#include <string>
+#include <vector>
+#include <cerrno>
+#include <cstring>
+#include <cstdint>
+#include <stdexcept>
+#include <unistd.h>
+#include <fcntl.h>
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <sys/sendfile.h>
+#endif
+
+/** @file FileCopy.hpp
+ * Copying byte ranges between files without passing them through user
+ * space where the kernel allows it.
+ */
+
+using namespace std;
+
+namespace fastaplus {
+
+/*!
+ * WriteAll function writes N bytes to a file descriptor, retrying short
+ * writes.
+ * @param Fd [int]
+ * @param Data [const char*]
+ * @param N [size_t]
+ */
+inline void WriteAll(int Fd, const char* Data, size_t N){
+   while (N > 0){
+      ssize_t w = write(Fd, Data, N);
+      if (w < 0 && errno == EINTR)
+         continue;
+      if (w <= 0)
+         throw runtime_error (string("Write failed: ") + strerror(errno));
+      Data += w;
+      N -= w;
+   }
+}
+
+/*!
+ * ReadAt function reads N bytes at Offset of a file descriptor, retrying
+ * short reads. The file position is not used or changed.
+ * @param Fd [int]
+ * @param Data [char*]
+ * @param N [size_t]
+ * @param Offset [uint64_t]
+ */
+inline void ReadAt(int Fd, char* Data, size_t N, uint64_t Offset){
+   while (N > 0){
+      ssize_t r = pread(Fd, Data, N, Offset);
+      if (r < 0 && errno == EINTR)
+         continue;
+      if (r < 0)
+         throw runtime_error (string("Read failed: ") + strerror(errno));
+      if (r == 0)
+         throw runtime_error ("Unexpected end of file while reading");
+      Data += r;
+      N -= r;
+      Offset += r;
+   }
+}
+
+/*!
+ * CopyRange function appends Len bytes of In, starting at Offset, to the
+ * current position of Out. It tries copy_file_range (in kernel, possibly
+ * reflinked), then sendfile, then falls back to pread/write. The file
+ * position of In is not used or changed.
+ * @param In [int]
+ * @param Offset [uint64_t]
+ * @param Len [uint64_t]
+ * @param Out [int]
+ */
+inline void CopyRange(int In, uint64_t Offset, uint64_t Len, int Out){
+   off_t off = Offset;
+
+#if defined(__linux__) && defined(SYS_copy_file_range)
+   while (Len > 0){
+      ssize_t n = syscall(SYS_copy_file_range, In, &off, NULL, Out, NULL, (size_t) Len, 0u);
+      if (n < 0 && errno == EINTR)
+         continue;
+      if (n <= 0)
+         break;                /* unsupported here (EXDEV, ENOSYS, ...) or EOF */
+      Len -= n;
+   }
+#endif
+#if defined(__linux__)
+   while (Len > 0){
+      ssize_t n = sendfile(Out, In, &off, (size_t) Len);
+      if (n < 0 && errno == EINTR)
+         continue;
+      if (n <= 0)
+         break;
+      Len -= n;
+   }
+#endif
+
+   vector<char> buf;
+   while (Len > 0){
+      if (buf.empty())
+         buf.resize(1 << 20);
+      ssize_t n = pread(In, buf.data(), (size_t) min<uint64_t>(Len, buf.size()), off);
+      if (n < 0 && errno == EINTR)
+         continue;
+      if (n < 0)
+         throw runtime_error (string("Read failed: ") + strerror(errno));
+      if (n == 0)
+         throw runtime_error ("Unexpected end of file while copying");
+      WriteAll(Out, buf.data(), n);
+      off += n;
+      Len -= n;
+   }
+}
+
+}
+
+#endif
@@ -0,0 +1,139 @@
+/*
+ * Hash128.hpp
+ *
+ * Copyright 2016 Robert Bakaric <rbakaric@irb.hr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+
+#ifndef FASTAPLUS_UTILITY_HASH128_HPP
+#define FASTAPLUS_UTILITY_HASH128_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+#include <string>
+
+/** @file Hash128.hpp
+ * 128 bit content hash (MurmurHash3, x64 variant) used to recognise
+ * sequences seen before.
+ */
+
+using namespace std;
+
+namespace fastaplus {
+
+/**
+ * @brief 128 bit hash value.
+ */
+struct Hash128{
+   uint64_t lo;
+   uint64_t hi;
+
+   bool operator==(const Hash128& o) const { return lo == o.lo && hi == o.hi; }
+   bool operator!=(const Hash128& o) const { return !(*this == o); }
+};
+
+/**
+ * @brief Hasher for unordered containers keyed by Hash128.
+ */
+struct Hash128Hasher{
+   size_t operator()(const Hash128& h) const { return (size_t) (h.lo ^ (h.hi * 0x9e3779b97f4a7c15ULL)); }
+};
+
+
+inline uint64_t HashRotl(uint64_t x, int r){
+   return (x << r) | (x >> (64 - r));
+}
+
+inline uint64_t HashFmix(uint64_t k){
+   k ^= k >> 33;
+   k *= 0xff51afd7ed558ccdULL;
+   k ^= k >> 33;
+   k *= 0xc4ceb9fe1a85ec53ULL;
+   k ^= k >> 33;
+   return k;
+}
+
+/*!
+ * HashBytes function hashes N bytes of Data.
+ * @param Data [const void*]
+ * @param N [size_t]
+ * @param Seed [uint64_t] // different seeds give independent hashes
+ */
+inline Hash128 HashBytes(const void* Data, size_t N, uint64_t Seed = 0){
+   const unsigned char* p = (const unsigned char*) Data;
+   const size_t nblocks = N / 16;
+   const uint64_t c1 = 0x87c37b91114253d5ULL;
+   const uint64_t c2 = 0x4cf5ad432745937fULL;
+   uint64_t h1 = Seed, h2 = Seed;
+
+   for (size_t i = 0; i < nblocks; i++){
+      uint64_t k1, k2;
+      memcpy(&k1, p + 16*i, 8);
+      memcpy(&k2, p + 16*i + 8, 8);
+
+      k1 *= c1; k1 = HashRotl(k1, 31); k1 *= c2; h1 ^= k1;
+      h1 = HashRotl(h1, 27); h1 += h2; h1 = h1*5 + 0x52dce729;
+      k2 *= c2; k2 = HashRotl(k2, 33); k2 *= c1; h2 ^= k2;
+      h2 = HashRotl(h2, 31); h2 += h1; h2 = h2*5 + 0x38495ab5;
+   }
+
+   const unsigned char* tail = p + 16*nblocks;
+   uint64_t k1 = 0, k2 = 0;
+   switch (N & 15){
+      case 15: k2 ^= (uint64_t) tail[14] << 48; /* fall through */
+      case 14: k2 ^= (uint64_t) tail[13] << 40; /* fall through */
+      case 13: k2 ^= (uint64_t) tail[12] << 32; /* fall through */
+      case 12: k2 ^= (uint64_t) tail[11] << 24; /* fall through */
+      case 11: k2 ^= (uint64_t) tail[10] << 16; /* fall through */
+      case 10: k2 ^= (uint64_t) tail[ 9] << 8;  /* fall through */
+      case  9: k2 ^= (uint64_t) tail[ 8];
+               k2 *= c2; k2 = HashRotl(k2, 33); k2 *= c1; h2 ^= k2; /* fall through */
+      case  8: k1 ^= (uint64_t) tail[ 7] << 56; /* fall through */
+      case  7: k1 ^= (uint64_t) tail[ 6] << 48; /* fall through */
+      case  6: k1 ^= (uint64_t) tail[ 5] << 40; /* fall through */
+      case  5: k1 ^= (uint64_t) tail[ 4] << 32; /* fall through */
+      case  4: k1 ^= (uint64_t) tail[ 3] << 24; /* fall through */
+      case  3: k1 ^= (uint64_t) tail[ 2] << 16; /* fall through */
+      case  2: k1 ^= (uint64_t) tail[ 1] << 8;  /* fall through */
+      case  1: k1 ^= (uint64_t) tail[ 0];
+               k1 *= c1; k1 = HashRotl(k1, 31); k1 *= c2; h1 ^= k1;
+   }
+
+   h1 ^= N; h2 ^= N;
+   h1 += h2; h2 += h1;
+   h1 = HashFmix(h1); h2 = HashFmix(h2);
+   h1 += h2; h2 += h1;
+
+   Hash128 h = {h1, h2};
+   return h;
+}
+
+/*!
+ * HashString function overload hashing the bytes of a string.
+ * @param Str [const string&]
+ * @param Seed [uint64_t]
+ */
+inline Hash128 HashString(const string& Str, uint64_t Seed = 0){
+   return HashBytes(Str.data(), Str.size(), Seed);
+}
+
+}
+
+#endif
@@ -0,0 +1,141 @@
+/*
+ * Random.hpp
+ *
+ * Copyright 2016 Robert Bakaric <rbakaric@irb.hr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+
+#ifndef FASTAPLUS_UTILITY_RANDOM_HPP
+#define FASTAPLUS_UTILITY_RANDOM_HPP
+
+#include <cstdint>
+#include <cmath>
+#include <limits>
+
+/** @file Random.hpp
+ * Small, seedable pseudo random number generator (xoshiro256**) used for
+ * sampling. The same seed gives the same stream on every platform.
+ */
+
+using namespace std;
+
+namespace fastaplus {
+
+/*!
+ * SplitMix64 function advances State and returns the next output; used to
+ * expand one seed into a generator state.
+ * @param State [uint64_t&]
+ */
+inline uint64_t SplitMix64(uint64_t& State){
+   uint64_t z = (State += 0x9e3779b97f4a7c15ULL);
+   z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+   z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+   return z ^ (z >> 31);
+}
+
+/*!
+ * StreamSeed function derives the seed of the independent sub stream
+ * number Stream (a chunk, a thread, ...) from a run seed, so that results
+ * depend on the seed and on how work is cut, not on who does it.
+ * @param Seed [uint64_t]
+ * @param Stream [uint64_t]
+ */
+inline uint64_t StreamSeed(uint64_t Seed, uint64_t Stream){
+   uint64_t s = Stream;
+   return Seed ^ SplitMix64(s);
+}
+
+/**
+ * @brief xoshiro256** generator. Meets the UniformRandomBitGenerator
+ * requirements, so it can also drive the std distributions.
+ *
+ * @par Example:
+ * @code
+ * Random rng(42);
+ * uint64_t i = rng.Below(100);   // 0..99
+ * double   u = rng.Uniform();    // (0,1]
+ * @endcode
+ */
+class Random {
+
+   uint64_t s[4];
+
+   static uint64_t Rotl(uint64_t x, int k){ return (x << k) | (x >> (64 - k)); }
+
+   public:
+
+   typedef uint64_t result_type;
+
+/*!
+ * Random class constructor.
+ * @param Seed [uint64_t]
+ */
+   explicit Random(uint64_t Seed = 0){ SetSeed(Seed); }
+
+/*!
+ * SetSeed function restarts the stream from Seed.
+ * @param Seed [uint64_t]
+ */
+   void SetSeed(uint64_t Seed){
+      for (int i = 0; i < 4; i++)
+         s[i] = SplitMix64(Seed);
+   }
+
+   static constexpr uint64_t min(){ return 0; }
+   static constexpr uint64_t max(){ return numeric_limits<uint64_t>::max(); }
+
+/*!
+ * Next 64 random bits.
+ */
+   uint64_t operator()(){
+      uint64_t r = Rotl(s[1] * 5, 7) * 9;
+      uint64_t t = s[1] << 17;
+      s[2] ^= s[0];
+      s[3] ^= s[1];
+      s[1] ^= s[2];
+      s[0] ^= s[3];
+      s[2] ^= t;
+      s[3] = Rotl(s[3], 45);
+      return r;
+   }
+
+/*!
+ * Uniform function returns a double in (0,1], so its logarithm is finite.
+ */
+   double Uniform(){
+      return ((*this)() >> 11 ) * (1.0 / 9007199254740992.0) + (1.0 / 9007199254740992.0);
+   }
+
+/*!
+ * Below function returns an unbiased integer in [0,n).
+ * @param n [uint64_t] // at least 1
+ */
+   uint64_t Below(uint64_t n){
+      uint64_t lim = (0 - n) % n;       /* 2^64 mod n */
+      uint64_t r;
+      do{
+         r = (*this)();
+      }while (r < lim);
+      return r % n;
+   }
+};
+
+}
+
+#endif
@@ -0,0 +1,252 @@
+/*
+ * Reservoir.hpp
+ *
+ * Copyright 2016 Robert Bakaric <rbakaric@irb.hr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+
+#ifndef FASTAPLUS_UTILITY_RESERVOIR_HPP
+#define FASTAPLUS_UTILITY_RESERVOIR_HPP
+
+#include <string>
+#include <vector>
+#include <unordered_set>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <Utility/Random.hpp>
+
+/** @file Reservoir.hpp
+ * Sampling of k items, from a stream of unknown length or from n items
+ * that can be accessed at random; uniform or weighted.
+ */
+
+using namespace std;
+
+namespace fastaplus {
+
+/*!
+ * SampleDistinct function draws k distinct numbers of [0,n) uniformly
+ * (Floyd's algorithm): k draws and O(k) memory whatever n is. The result
+ * is sorted.
+ * @param n [uint64_t]
+ * @param k [uint64_t] // at most n
+ * @param Rng [Random&]
+ */
+inline vector<uint64_t> SampleDistinct(uint64_t n, uint64_t k, Random& Rng){
+   unordered_set<uint64_t> picked;
+   picked.reserve(k);
+   for (uint64_t j = n - k; j < n; j++){
+      uint64_t t = Rng.Below(j + 1);
+      if (!picked.insert(t).second)
+         picked.insert(j);
+   }
+   vector<uint64_t> out(picked.begin(), picked.end());
+   sort(out.begin(), out.end());
+   return out;
+}
+
+/**
+ * @brief Reservoir sampler (Li's Algorithm L). Holds k items; the number
+ * of random draws is O(k (1 + log(n/k))) instead of one per item.
+ *
+ * Slot() is called once per item of the stream and tells where the item
+ * goes, so items that are skipped never have to be built.
+ *
+ * @par Example:
+ * @code
+ * Reservoir<string> r(10, 42);
+ * while (Reader.Next(cap, corp)){
+ *    long s = r.Slot();
+ *    if (s >= 0)
+ *       r[s] = cap;
+ * }
+ * @endcode
+ */
+template <typename T>
+class Reservoir {
+
+   vector<T> Items;
+   size_t    K;
+   uint64_t  Seen;      /* items offered so far */
+   uint64_t  Take;      /* index of the next item to take once full */
+   double    W;
+   Random    Rng;
+
+   void Skip(){
+      double gap = floor(log(Rng.Uniform()) / log1p(-W));
+      Take = (gap < 1e18) ? Take + (uint64_t) gap + 1 : UINT64_MAX;
+   }
+
+   public:
+
+/*!
+ * Reservoir class constructor.
+ * @param k [size_t] // sample size
+ * @param Seed [uint64_t]
+ */
+   Reservoir(size_t k, uint64_t Seed):K(k), Seen(0), Take(k ? k - 1 : 0), W(0), Rng(Seed){
+      Items.reserve(k);
+   }
+
+/*!
+ * Slot function accounts for the next item of the stream and returns the
+ * position it has to be stored at, or -1 if it is not part of the sample.
+ */
+   long Slot(){
+      uint64_t i = Seen++;
+      if (i < K){
+         Items.resize(i + 1);
+         if (i + 1 == K && K > 0){
+            W = exp(log(Rng.Uniform()) / K);
+            Skip();
+         }
+         return (long) i;
+      }
+      if (K == 0 || i != Take)
+         return -1;
+      long s = (long) Rng.Below(K);
+      W *= exp(log(Rng.Uniform()) / K);
+      Skip();
+      return s;
+   }
+
+   T& operator[](size_t i){ return Items[i]; }
+
+/*!
+ * GetSample function returns the sampled items (min(k, n) of them).
+ */
+   vector<T>& GetSample(){ return Items; }
+
+/*!
+ * Object data getter. \n
+ * Getter retrieves the number of items offered ("Seen").
+ * @param What [const string&]
+ */
+   uint64_t GetObjSummary(const string& What){
+      if (What.compare("Seen") == 0)
+         return Seen;
+      return 0;
+   }
+};
+
+
+/**
+ * @brief Weighted reservoir sampler (Efraimidis and Spirakis, A-ExpJ).
+ *
+ * Item i gets the key u^(1/w_i), u uniform, and the k largest keys form the
+ * sample; the jumps of A-ExpJ draw random numbers only for the items that
+ * enter the reservoir. Keys are kept as logarithms, log(u)/w, which stay
+ * accurate for long sequences.
+ *
+ * Because the sample is defined by keys, reservoirs filled from disjoint
+ * parts of a stream can be merged by keeping the k largest keys of their
+ * union, which gives a sample of the whole stream.
+ *
+ * @par Example:
+ * @code
+ * Random rng(42);
+ * WeightedReservoir<string> r(10, rng);
+ * while (Reader.Next(cap, corp)){
+ *    long s = r.Slot(corp.size());
+ *    if (s >= 0)
+ *       r[s] = cap;
+ * }
+ * @endcode
+ */
+template <typename T>
+class WeightedReservoir {
+
+   vector<T>      Items;
+   vector<double> Keys;       /* log key of each slot */
+   vector<size_t> Heap;       /* slots, smallest key on top */
+   size_t         K;
+   double         Jump;       /* weight still to pass before the next entry */
+   Random*        Rng;
+
+   struct KeyGreater{
+      const vector<double>* keys;
+      bool operator()(size_t a, size_t b) const { return (*keys)[a] > (*keys)[b]; }
+   };
+
+   void NewJump(){
+      Jump = log(Rng->Uniform()) / Keys[Heap.front()];
+   }
+
+   public:
+
+/*!
+ * WeightedReservoir class constructor.
+ * @param k [size_t] // sample size
+ * @param rng [Random&] // used by this reservoir from now on
+ */
+   WeightedReservoir(size_t k, Random& rng):K(k), Jump(0), Rng(&rng){}
+
+/*!
+ * Slot function accounts for the next item of the stream and returns the
+ * position it has to be stored at, or -1 if it is not (yet) part of the
+ * sample.
+ * @param w [double] // weight, greater than 0
+ */
+   long Slot(double w){
+      KeyGreater cmp = {&Keys};
+      if (K == 0)
+         return -1;
+      if (Items.size() < K){
+         size_t s = Items.size();
+         Items.resize(s + 1);
+         Keys.push_back(log(Rng->Uniform()) / w);
+         Heap.push_back(s);
+         push_heap(Heap.begin(), Heap.end(), cmp);
+         if (Items.size() == K)
+            NewJump();
+         return (long) s;
+      }
+      Jump -= w;
+      if (Jump > 0)
+         return -1;
+
+      /* the new key is conditioned to beat the smallest one */
+      double tw = exp(w * Keys[Heap.front()]);
+      double r  = tw + (1 - tw) * Rng->Uniform();
+      pop_heap(Heap.begin(), Heap.end(), cmp);
+      size_t s = Heap.back();
+      Keys[s] = log(r) / w;
+      push_heap(Heap.begin(), Heap.end(), cmp);
+      NewJump();
+      return (long) s;
+   }
+
+/*!
+ * Key function returns the (log) key of slot i.
+ * @param i [size_t]
+ */
+   double Key(size_t i) const { return Keys[i]; }
+
+   T& operator[](size_t i){ return Items[i]; }
+
+/*!
+ * GetSample function returns the sampled items (min(k, n) of them).
+ */
+   vector<T>& GetSample(){ return Items; }
+};
+
+}
+
+#endif
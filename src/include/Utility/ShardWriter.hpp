@@ -0,0 +1,315 @@
+/*
+ * ShardWriter.hpp
+ *
+ * Copyright 2016 Robert Bakaric <rbakaric@irb.hr>
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston,
+ * MA 02110-1301, USA.
+ *
+ *
+ */
+
+#ifndef FASTAPLUS_UTILITY_SHARDWRITER_HPP
+#define FASTAPLUS_UTILITY_SHARDWRITER_HPP
+
+#include <list>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <stdexcept>
+#include <algorithm>
+#include <unistd.h>
+#include <fcntl.h>
+#include <Utility/FileCopy.hpp>
+#include <Utility/ConvertString.hpp>
+
+/** @file ShardWriter.hpp
+ * Buffered output to any number of files through a bounded number of
+ * open file descriptors.
+ */
+
+using namespace std;
+
+namespace fastaplus {
+
+/**
+ * @brief Writer for many output files (shards).
+ *
+ * Output is collected per shard in memory. A shard is written out in one
+ * large write when its buffer reaches FlushSize, and the largest buffers
+ * are written out whenever all of them together exceed Budget. At most
+ * MaxOpen files are open at a time; the least recently written one is
+ * closed to make room and later reopened for appending.
+ *
+ * Shard i is the file Prefix + (i+1) unless a path was set with SetPath.
+ */
+class ShardWriter {
+
+   struct Shard{
+      vector<char> buf;
+      int  fd;
+      bool created;                    /* truncated by this writer */
+      list<size_t>::iterator lru;      /* position in Open, if fd >= 0 */
+      string path;                     /* empty: Prefix + (i+1) */
+   };
+
+   string Prefix;
+   size_t MaxOpen;
+   size_t Budget;
+   size_t FlushSize;
+   size_t CopySize;
+
+   vector<Shard> Shards;
+   list<size_t>  Open;                 /* open shards, most recent first */
+   size_t        Buffered;             /* bytes in all buffers */
+
+/* Counters */
+   unsigned long Writes;
+   unsigned long Opens;
+
+   Shard& At(size_t i);
+   string PathOf(size_t i);
+   int    Fd(size_t i);
+   void   Flush(size_t i);
+   void   Shrink();
+   void   CloseFd(size_t i);
+
+   public:
+
+/*!
+ * ShardWriter class constructor.
+ * @param prefix [const string&] // shard i is prefix + (i+1)
+ * @param maxopen [size_t] // open files at most (default 256)
+ * @param budget [size_t] // buffered bytes at most (default 64 MB)
+ * @param flushsize [size_t] // a shard is written out at this size (default 1 MB)
+ * @param copysize [size_t] // Copy leaves ranges of this size to the kernel (default 32 KB)
+ */
+   ShardWriter(const string& prefix, size_t maxopen = 256, size_t budget = 1 << 26, size_t flushsize = 1 << 20,
+               size_t copysize = 1 << 15);
+
+/*!
+ * ShardWriter class destructor. Writes out what is left; errors are
+ * only reported by Close.
+ */
+   ~ShardWriter();
+
+/*!
+ * SetPath function names the file of shard i.
+ * @param i [size_t]
+ * @param path [const string&]
+ */
+   void SetPath(size_t i, const string& path);
+
+/*!
+ * Create function creates (truncates) the file of shard i, so that it
+ * exists even if nothing is written to it.
+ * @param i [size_t]
+ */
+   void Create(size_t i);
+
+/*!
+ * Write function appends n bytes to shard i.
+ * @param i [size_t]
+ * @param p [const char*]
+ * @param n [size_t]
+ */
+   void Write(size_t i, const char* p, size_t n);
+
+/*!
+ * Copy function appends a byte range of another file to shard i. Ranges
+ * of at least CopySize are copied by the kernel (see CopyRange), shorter
+ * ones are read into the buffer.
+ * @param i [size_t]
+ * @param in [int] // file descriptor
+ * @param off [uint64_t]
+ * @param len [uint64_t]
+ */
+   void Copy(size_t i, int in, uint64_t off, uint64_t len);
+
+/*!
+ * Close function writes out all buffers and closes all files.
+ */
+   void Close();
+
+/*!
+ * Object data getter. \n
+ * Getter retrieves the number of "Shards", "Writes" (system calls) and
+ * file "Opens".
+ * @param What [const string&]
+ */
+   unsigned long GetObjSummary(const string& What);
+
+};
+
+
+/* Constructors */
+inline ShardWriter::ShardWriter(const string& prefix, size_t maxopen, size_t budget, size_t flushsize, size_t copysize)
+   :Prefix(prefix), MaxOpen(maxopen ? maxopen : 1), Budget(budget), FlushSize(flushsize ? flushsize : 1),
+    CopySize(copysize ? copysize : 1), Buffered(0), Writes(0), Opens(0){}
+
+/* Destructors */
+inline ShardWriter::~ShardWriter(){
+   try{
+      Close();
+   }catch(...){
+      for (list<size_t>::iterator it = Open.begin(); it != Open.end(); ++it)
+         close(Shards[*it].fd);
+   }
+}
+
+
+/* Functions  : Public */
+
+inline void ShardWriter::SetPath(size_t i, const string& path){
+   At(i).path = path;
+}
+
+inline void ShardWriter::Create(size_t i){
+   if (!At(i).created)
+      Fd(i);
+}
+
+inline void ShardWriter::Write(size_t i, const char* p, size_t n){
+   Shard& s = At(i);
+   if (n >= FlushSize){
+      Flush(i);
+      WriteAll(Fd(i), p, n);
+      Writes++;
+      return;
+   }
+   s.buf.insert(s.buf.end(), p, p + n);
+   Buffered += n;
+   if (s.buf.size() >= FlushSize)
+      Flush(i);
+   else if (Buffered > Budget)
+      Shrink();
+}
+
+inline void ShardWriter::Copy(size_t i, int in, uint64_t off, uint64_t len){
+   Shard& s = At(i);
+   if (len >= CopySize){
+      Flush(i);
+      CopyRange(in, off, len, Fd(i));
+      Writes++;
+      return;
+   }
+   size_t n = s.buf.size();
+   s.buf.resize(n + len);
+   try{
+      ReadAt(in, s.buf.data() + n, len, off);
+   }catch(...){
+      s.buf.resize(n);
+      throw;
+   }
+   Buffered += len;
+   if (s.buf.size() >= FlushSize)
+      Flush(i);
+   else if (Buffered > Budget)
+      Shrink();
+}
+
+inline void ShardWriter::Close(){
+   for (size_t i = 0; i < Shards.size(); i++)
+      Flush(i);
+   while (!Open.empty())
+      CloseFd(Open.back());
+}
+
+inline unsigned long ShardWriter::GetObjSummary(const string& What){
+   if (What.compare("Shards") == 0)
+      return Shards.size();
+   else if (What.compare("Writes") == 0)
+      return Writes;
+   else if (What.compare("Opens") == 0)
+      return Opens;
+   return 0;
+}
+
+
+/* Functions  : Private */
+
+inline ShardWriter::Shard& ShardWriter::At(size_t i){
+   while (Shards.size() <= i){
+      Shards.push_back(Shard());
+      Shards.back().fd = -1;
+      Shards.back().created = false;
+   }
+   return Shards[i];
+}
+
+inline string ShardWriter::PathOf(size_t i){
+   return Shards[i].path.empty() ? Prefix + NumericToString(i + 1) : Shards[i].path;
+}
+
+/* Open file of shard i, opening it (and closing the least recently
+ * used one) if needed. */
+inline int ShardWriter::Fd(size_t i){
+   Shard& s = Shards[i];
+   if (s.fd >= 0){
+      Open.splice(Open.begin(), Open, s.lru);
+      return s.fd;
+   }
+   if (Open.size() >= MaxOpen)
+      CloseFd(Open.back());
+
+   /* no O_APPEND on reopening: copy_file_range and sendfile refuse it */
+   string path = PathOf(i);
+   s.fd = open(path.c_str(), s.created ? O_WRONLY : (O_WRONLY | O_CREAT | O_TRUNC), 0644);
+   if (s.fd < 0)
+      throw runtime_error ("Cannot open file: " + path );
+   if (s.created && lseek(s.fd, 0, SEEK_END) < 0){
+      close(s.fd);
+      s.fd = -1;
+      throw runtime_error ("Cannot open file: " + path );
+   }
+   s.created = true;
+   Opens++;
+   Open.push_front(i);
+   s.lru = Open.begin();
+   return s.fd;
+}
+
+inline void ShardWriter::Flush(size_t i){
+   Shard& s = Shards[i];
+   if (s.buf.empty())
+      return;
+   WriteAll(Fd(i), s.buf.data(), s.buf.size());
+   Writes++;
+   Buffered -= s.buf.size();
+   vector<char>().swap(s.buf);     /* idle shards hold no memory */
+}
+
+/* Write out the largest buffers until half the budget is free. */
+inline void ShardWriter::Shrink(){
+   vector<pair<size_t, size_t>> full;                  /* size, shard */
+   for (size_t i = 0; i < Shards.size(); i++)
+      if (!Shards[i].buf.empty())
+         full.push_back(make_pair(Shards[i].buf.size(), i));
+   sort(full.begin(), full.end(), greater<pair<size_t, size_t>>());
+
+   for (size_t k = 0; k < full.size() && Buffered > Budget / 2; k++)
+      Flush(full[k].second);
+}
+
+inline void ShardWriter::CloseFd(size_t i){
+   Shard& s = Shards[i];
+   Open.erase(s.lru);
+   close(s.fd);
+   s.fd = -1;
+}
+
+}
+
+#endif